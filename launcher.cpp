@@ -0,0 +1,40 @@
+#include <cstdio>
+#include <iostream>
+#include <string>
+
+#include <limits.h>
+#include <unistd.h>
+
+// Picks the engine build matching the instruction sets of this CPU and replaces itself with it.
+// The builds are expected next to the launcher, as CMakeLists.txt puts them.
+
+std::string executableDirectory(const char *argv0){
+    char path[PATH_MAX];
+    ssize_t length = readlink("/proc/self/exe", path, sizeof(path) - 1);
+    std::string self = length > 0 ? std::string(path, length) : std::string(argv0);
+
+    size_t slash = self.find_last_of('/');
+    return slash == std::string::npos ? std::string(".") : self.substr(0, slash);
+}
+
+int main([[maybe_unused]] int argc, char *argv[]){
+    __builtin_cpu_init();
+    const char *variants[] = {"x86-64-v3", "x86-64-v2", "generic"};
+    bool supported[] = {
+        __builtin_cpu_supports("x86-64-v3") != 0,
+        __builtin_cpu_supports("x86-64-v2") != 0,
+        true
+    };
+
+    std::string directory = executableDirectory(argv[0]);
+    for (int i = 0; i < 3; i ++){
+        if (!supported[i]) continue;
+        std::string engine = directory + "/ChessEngine-" + variants[i];
+        argv[0] = engine.data();
+        execv(engine.c_str(), argv);
+        // only returns when the build is missing, so fall back to the next one
+    }
+
+    std::cerr << "no engine build found in " << directory << std::endl;
+    return 1;
+}
@@ -1,272 +1,142 @@
-#include <bitset>
 #include <iostream>
 #include <chrono>
-#include <unordered_map>
-#include <math.h>
-#include <limits>
 #include <vector>
-#include <cassert>
+#include <stdexcept>
+#include <string>
+#include <thread>
 #include <algorithm>
-#include <random>
 
+#include "src/Batch.h"
+#include "src/Bench.h"
 #include "src/ChessBoard.h"
-#include "src/TranspositionTable.h"
-#include "src/notation.h"
-#include "src/Evaluation.h"
-
-#define INF std::numeric_limits<float>::infinity()
-#define DEPTH 11
-
-
-int staticExchangeEval(const ChessMove &move, int sideToMove, float gamePhase){
-    int res = pieceValue(move.getCaptured(), 1 - sideToMove, gamePhase, move.getEndSquare()) 
-        - pieceValue(move.getPiece(), sideToMove, gamePhase, move.getStartingSquare());
-
-    return res + (move.isPromo() ? pieceValue(move.getPromoPiece(), sideToMove, gamePhase, move.getEndSquare()) : 0);
-}
-
-int staticMoveEval(const ChessMove &move, int sideToMove, float gamePhase){
-    return pieceValue(move.isPromo() ? move.getPromoPiece() : move.getPiece(), sideToMove, gamePhase, move.getEndSquare())
-        - pieceValue(move.getPiece(), sideToMove, gamePhase, move.getStartingSquare());
-}
-
-
-void orderCaptures(std::vector<ChessMove> &moveList, int sideToMove, float gamePhase){
-    std::sort(
-        moveList.begin(), moveList.end(), [sideToMove, gamePhase](ChessMove a, ChessMove b){
-            return staticExchangeEval(a, sideToMove, gamePhase) > staticExchangeEval(b, sideToMove, gamePhase);
-        }
-    );
+#include "src/Network.h"
+#include "src/Perft.h"
+#include "src/Search.h"
+#include "src/Uci.h"
+
+int usage(const char *name){
+    std::cerr << "usage: " << name << " [--hash <MB>] [--nnue <file>]\n"
+        << "       " << name << " [--fen <FEN>] perft <depth>\n"
+        << "       " << name << " perftsuite\n"
+        << "       " << name << " [--hash <MB>] [--disable pvs|nullmove|lmr]... bench [depth]\n"
+        << "       " << name << " [--hash <MB>] smpbench [depth]\n"
+        << "       " << name << " sliderbench\n"
+        << "       " << name << " [--hash <MB>] --nnue <file> nnuebench [depth]\n"
+        << "       " << name << " [--hash <MB>] [--nnue <file>] [--threads <N>] batch <file> [depth <N>] [nodes <N>] [movetime <ms>]" << std::endl;
+    return 1;
 }
 
-void  orderQuiets(std::vector<ChessMove> &moveList, int sideToMove, float gamePhase){
-    std::sort(
-        moveList.begin(), moveList.end(), [sideToMove, gamePhase](ChessMove a, ChessMove b){
-            return staticMoveEval(a, sideToMove, gamePhase) > staticMoveEval(b, sideToMove, gamePhase);
-        }
-    );
-}
-
-float quiescence(ChessBoard &pos, float alpha, float beta){
-    int sign = (1 - 2*pos.getSideToMove());
-    int checkingPiece;
-    bool evadeChecks = pos.checkInfo(checkingPiece);
-    bool unableToMove = true;
-    float bestScore  = evadeChecks ? -INF : sign * evaluate(pos.getBitBoards(), 1.0f); 
-
-    if(bestScore >= beta) return bestScore;
-    if(bestScore > alpha) alpha = bestScore;
-
-    std::vector<ChessMove> moveList = pos.getCaptures();
-    orderCaptures(moveList, pos.getSideToMove(), pos.getGamePhase());
-
-    for(auto move = moveList.begin(); move != moveList.end() && alpha < beta; ++ move){
-        if(!evadeChecks || move->getCaptured() == checkingPiece){
-            pos.makeMove(*move);
-            if(pos.isLegal()){
-                unableToMove = false;
-                float score = - quiescence(pos, -beta, -alpha);
-                if(score > bestScore){
-                bestScore = score;
-                    if(score > alpha) alpha = bestScore;
-                }
-            }        
-            pos.undoMove(*move);
-        }
-    }
-
-    if(evadeChecks){
-        std::vector<ChessMove> quietList = pos.getQuiets(); //no move ordering, moves must just be legal
-
-        for(auto move = quietList.begin(); move != quietList.end() && alpha < beta; ++ move){
-            if(!move->isCastle()){
-                pos.makeMove(*move);
-                if(pos.isLegal()){
-                    unableToMove = false;
-                    float score = - quiescence(pos, -beta, -alpha);
-                    if(score > bestScore){
-                    bestScore = score;
-                        if(score > alpha) alpha = bestScore;
-                    }
-                }        
-                pos.undoMove(*move);
+int main(int argc, char *argv[]){
+    size_t hashMegaBytes = 16;
+    int threads = std::max<int>(1, std::thread::hardware_concurrency());
+    std::string fen = "rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1";
+    std::string networkFile;
+    SearchFeatures features;
+    std::vector<std::string> args;
+    // a number that does not parse gets the usage message instead of an uncaught exception
+    try {
+        for (int i = 1; i < argc; i ++){
+            std::string arg = argv[i];
+            if (arg == "--hash" && i + 1 < argc) hashMegaBytes = std::stoul(argv[++ i]);
+            else if (arg == "--fen" && i + 1 < argc) fen = argv[++ i];
+            else if (arg == "--nnue" && i + 1 < argc) networkFile = argv[++ i];
+            else if (arg == "--threads" && i + 1 < argc) threads = std::max(1, std::stoi(argv[++ i]));
+            else if (arg == "--disable" && i + 1 < argc){
+                std::string feature = argv[++ i];
+                if (feature == "pvs") features.pvs = false;
+                else if (feature == "nullmove") features.nullMove = false;
+                else if (feature == "lmr") features.lateMoveReductions = false;
+                else return usage(argv[0]);
             }
+            else args.push_back(arg);
         }
     }
-
-    if(evadeChecks && unableToMove) bestScore = - CHECKMATE;
-
-    return bestScore;
-}
-
-float alphaBeta(ChessBoard &pos, TranspositionTable &map, std::vector<ChessMove> &pv, bool followPV,int depth, float alpha, float beta)
-{
-    
-    Value val;
-    if(map.getValue(pos, val) && (val.depth >= depth || val.nodeType == endNode)){
-        if(val.nodeType == pvNode) return val.score;
-        if(val.nodeType == allNode && val.score < alpha) return val.score;
-        if(val.nodeType == cutNode && val.score > beta) return val.score;
-        if(val.nodeType == endNode){
-            if(val.score < 0) return -(CHECKMATE + depth);
-            else return 0.0f;
-        }
+    catch (const std::invalid_argument &) {
+        return usage(argv[0]);
     }
-    
-    if(depth == 0){
-        float score = quiescence(pos, alpha, beta);
-        return score;
+    catch (const std::out_of_range &) {
+        return usage(argv[0]);
     }
 
-    float bestScore = -INF;
-    int nodeType = allNode;
-    int checkingPiece;
-    bool unableToMove = true;
-    bool searchedPV = false;
-    bool posIsCheck = pos.checkInfo(checkingPiece);
-    ChessMove pvMove;
-
-    if(followPV && pv.size() != 0){
-        searchedPV = true;
-        pvMove = pv.back();
-        pos.makeMove(pvMove);
-        unableToMove = false;
-        std::vector<ChessMove> variation;
-        variation.assign(pv.begin(), pv.end() - 1); 
-        float score = -alphaBeta(pos, map, variation, followPV, depth - 1, -beta, -alpha);
-
-        if(score > bestScore){
-            bestScore = score;
-            if(bestScore > alpha) {
-                alpha = bestScore;
-                nodeType = alpha >= beta ? cutNode : pvNode;
-                
-                variation.push_back(pvMove);
-                pv = variation;
-            }
+    // without a usable network the engine keeps the piece-square evaluation
+    if (!networkFile.empty()){
+        try {
+            Network::setActive(Network::load(networkFile));
         }
-        pos.undoMove(pvMove);
-    }
-
-    followPV = false;
-    if(nodeType != cutNode){
-        std::vector<ChessMove> captureList = pos.getCaptures();
-        orderCaptures(captureList, pos.getSideToMove(), pos.getGamePhase());
-
-        for(auto move = captureList.begin(); move != captureList.end() && nodeType != cutNode; ++ move){
-            if(!posIsCheck || move->getCaptured() == checkingPiece){
-                pos.makeMove(*move);
-                if(pos.isLegal() && !(searchedPV && *move == pvMove)){
-                    unableToMove = false;
-                    std::vector<ChessMove> variation;
-                    float score = -alphaBeta(pos, map, variation, followPV, depth - 1, -beta, -alpha);
-
-                    if(score > bestScore){
-                        bestScore = score;
-                        if(bestScore > alpha) {
-                            alpha = bestScore;
-                            nodeType = alpha >= beta ? cutNode : pvNode;
-                            
-                            variation.push_back(*move);
-                            pv = variation;
-                        }
-                    }
-                }
-                pos.undoMove(*move);
-            }
+        catch (const std::runtime_error &e) {
+            std::cerr << e.what() << ", using the piece-square evaluation" << std::endl;
         }
     }
-    if(nodeType != cutNode){
-        std::vector<ChessMove> quietList = pos.getQuiets();
-        orderQuiets(quietList, pos.getSideToMove(), pos.getGamePhase());
-
-        for(auto move = quietList.begin(); move != quietList.end() && nodeType != cutNode; ++ move){
-            pos.makeMove(*move);
-            if(pos.isLegal() && !(searchedPV && *move == pvMove)){
-                unableToMove = false;
-                std::vector<ChessMove> variation;
-                float score = -alphaBeta(pos, map, variation, followPV, depth - 1, -beta, -alpha);
 
-                if(score > bestScore){
-                    bestScore = score;
-                    if(bestScore > alpha) {
-                        alpha = bestScore;
-                        nodeType = alpha >= beta ? cutNode : pvNode;
-                        
-                        variation.push_back(*move);
-                        pv = variation;
-                    }
-                }
-            }
-            pos.undoMove(*move);
-        }
+    try {
+        ChessBoard{fen};
     }
-    
-    if(unableToMove) {
-        bestScore = posIsCheck ? -(CHECKMATE + depth) : 0.0f;
-        nodeType = endNode;
+    catch (const std::invalid_argument &e) {
+        std::cerr << e.what() << std::endl;
+        return 1;
     }
-    
-    map.insert(pos, bestScore, depth, nodeType);
-    return bestScore;
-}
-
-float iterativeDeepening(ChessBoard &pos, TranspositionTable &map, std::vector<ChessMove> &pv, int depth, int maxDepth, float alpha, float beta)
-{
-    auto start = std::chrono::high_resolution_clock::now();
-    float res = alphaBeta(pos, map, pv, true, depth, alpha, beta);
-    auto end = std::chrono::high_resolution_clock::now();
-    std::chrono::duration<double> elapsed = end - start;
-
-    std::cout << "at ply " << depth << " evaluation is ";
 
-    bool mating = false, gettingMated = false;
-    if(res <= -CHECKMATE){
-        gettingMated = true;
-        int pliesToMate = pos.getSideToMove() + ((depth-int(res-CHECKMATE))/2) + ((depth-int(res-CHECKMATE))%2);
-        std::cout << "mate in " << pliesToMate << "\t(" << elapsed.count() << "s)";
+    // the commands parse their own numbers, the same way
+    try {
+        if (args.size() == 2 && args[0] == "perft"){
+            ChessBoard cBoard(fen);
+            auto start = std::chrono::high_resolution_clock::now();
+            uint64_t nodes = divide(cBoard, std::stoi(args[1]), std::cout);
+            auto end = std::chrono::high_resolution_clock::now();
+            std::chrono::duration<double> elapsed = end - start;
+            std::cout << "time: " << elapsed.count() << "s, " << uint64_t(nodes / elapsed.count()) << " nps" << std::endl;
+            return 0;
+        }
+        if (args.size() == 1 && args[0] == "perftsuite") return runPerftSuite(std::cout) ? 0 : 1;
+        if (args.size() == 1 && args[0] == "sliderbench"){
+            runSliderBenchmark(std::cout);
+            return 0;
+        }
+        if (!args.empty() && args.size() <= 2 && args[0] == "bench"){
+            runSearchBenchmark(std::cout, args.size() == 2 ? std::stoi(args[1]) : 10, hashMegaBytes, features);
+            return 0;
+        }
+        if (!args.empty() && args.size() <= 2 && args[0] == "nnuebench"){
+            if (!Network::getActive()) return usage(argv[0]);
+            runNnueBenchmark(std::cout, args.size() == 2 ? std::stoi(args[1]) : 10, hashMegaBytes, Network::getActive());
+            return 0;
+        }
+        if (!args.empty() && args.size() <= 2 && args[0] == "smpbench"){
+            runSmpBenchmark(std::cout, args.size() == 2 ? std::stoi(args[1]) : 9, hashMegaBytes);
+            return 0;
+        }
+        if (args.size() >= 2 && args.size() % 2 == 0 && args[0] == "batch"){
+            // the budget of each position, a fixed depth unless told otherwise
+            SearchLimits limits;
+            for (size_t i = 2; i < args.size(); i += 2){
+                if (args[i] == "depth") limits.depth = std::stoi(args[i + 1]);
+                else if (args[i] == "nodes") limits.nodes = std::stoull(args[i + 1]);
+                else if (args[i] == "movetime") limits.moveTime = std::stoll(args[i + 1]);
+                else return usage(argv[0]);
+            }
+            if (!limits.depth && !limits.nodes && !limits.moveTime) limits.depth = 10;
 
+            try {
+                runBatch(args[1], limits, threads, hashMegaBytes, std::cout, std::cerr);
+            }
+            catch (const std::runtime_error &e) {
+                std::cerr << e.what() << std::endl;
+                return 1;
+            }
+            return 0;
+        }
+        if (!args.empty()) return usage(argv[0]);
     }
-    else if(res >= CHECKMATE){
-        mating = true;
-        int pliesToMate = pos.getSideToMove() + ((depth-int(res-CHECKMATE))/2) + ((depth-int(res-CHECKMATE))%2);
-        std::cout << "mate in " << pliesToMate << "\t(" << elapsed.count() << "s)";
+    catch (const std::invalid_argument &) {
+        return usage(argv[0]);
     }
-    else std::cout << res << "\t(" << elapsed.count() << "s)";
-
-    
-    if(res < alpha){
-        std::cout << " Fail low" << std::endl;
-        return iterativeDeepening(pos, map, pv, depth, maxDepth, -INF, beta);
+    catch (const std::out_of_range &) {
+        return usage(argv[0]);
     }
-    else if(res > beta){ 
-        std::cout << " Fail high"<< std::endl;
-        return iterativeDeepening(pos, map, pv, depth, maxDepth, alpha, INF);
-    }
-    else std::cout << std::endl;
-
-    if (depth == maxDepth) return res;
-
-    alpha = gettingMated ? res - 1.1f : res - 0.3f;
-    beta = mating ? res + 1.1f : res + 0.3f;
-    return iterativeDeepening(pos, map, pv, depth + 1, maxDepth, alpha, beta);
-}
-
-int main(){
-    TranspositionTable map(1<<20);
-    std::vector<ChessMove> pv;
-    ChessBoard cBoard;
-
-    std::cout << cBoard  << std::endl;
-    auto start = std::chrono::high_resolution_clock::now();
-    float result = iterativeDeepening(cBoard, map, pv, 0, DEPTH, -INF, INF);
-    auto end = std::chrono::high_resolution_clock::now();
-    std::chrono::duration<double> elapsed = end - start;
 
-    for(auto move = pv.begin(); move != pv.end(); ++move) std::cout << *move << std::endl;
-    std::cout << "Evaluation during search at depth " << DEPTH << " is " << result  << std::endl;
-    std::cout << "Tempo impiegato: " << elapsed.count() << " secondi" << std::endl;
-    std::cout << "Dimensione Transposition Table: " << map.getSize() << std::endl;
+    // without a command the engine speaks uci on the standard streams
+    Uci uci(hashMegaBytes);
+    uci.loop(std::cin);
 
     return 0;
 }
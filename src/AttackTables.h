@@ -0,0 +1,36 @@
+#pragma once
+
+#include <cstdint>
+
+// Precomputed attack sets, written at build time by tools/TableGenerator.cpp into AttackTables.cpp.
+// The only instance is constant initialized, so it lives in read-only data: startup does no work on it,
+// threads cannot race on it and processes running the same binary share its pages
+struct AttackTables
+{
+    uint64_t rayAttacks[64][8];
+    // squares strictly between two aligned squares, and the whole line through them, empty when not aligned
+    uint64_t between[64][64];
+    uint64_t line[64][64];
+    uint64_t knightAttacks[64];
+    uint64_t kingAttacks[64];
+    uint64_t pawnAttacks[64][2];
+    uint64_t pawnPushes[64][2];
+
+    unsigned int rShift[64];
+    uint64_t rMask[64];
+    uint64_t rMagic[64];
+    unsigned int bShift[64];
+    uint64_t bMask[64];
+    uint64_t bMagic[64];
+
+    uint64_t rMagicDb[64][1<<12];
+    uint64_t bMagicDb[64][1<<9];
+
+    // every square takes exactly 2^(relevant bits) entries, 800KB for rooks and 41KB for bishops
+    int rPextOffset[64];
+    int bPextOffset[64];
+    uint64_t rPextDb[102400];
+    uint64_t bPextDb[5248];
+};
+
+extern const AttackTables attackTables;
@@ -0,0 +1,243 @@
+#include "Batch.h"
+#include "ChessBoard.h"
+#include "Search.h"
+#include "TranspositionTable.h"
+
+#include <algorithm>
+#include <cctype>
+#include <cerrno>
+#include <chrono>
+#include <cstring>
+#include <map>
+#include <mutex>
+#include <optional>
+#include <sstream>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace
+{
+    // Read only view of a whole file, the kernel pages it in as the lines are reached and may drop the
+    // pages already read, so the size of the input does not matter
+    class MappedFile
+    {
+    public:
+        MappedFile(const std::string &t_path){
+            int fd = open(t_path.c_str(), O_RDONLY);
+            if(fd < 0) throw std::runtime_error("cannot open " + t_path + ": " + std::strerror(errno));
+
+            struct stat info;
+            if(fstat(fd, &info) < 0){
+                close(fd);
+                throw std::runtime_error("cannot read " + t_path + ": " + std::strerror(errno));
+            }
+            m_size = info.st_size;
+            if(m_size > 0){
+                void *data = mmap(nullptr, m_size, PROT_READ, MAP_PRIVATE, fd, 0);
+                if(data == MAP_FAILED){
+                    close(fd);
+                    throw std::runtime_error("cannot map " + t_path + ": " + std::strerror(errno));
+                }
+                madvise(data, m_size, MADV_SEQUENTIAL);
+                m_data = static_cast<const char*>(data);
+            }
+            close(fd);
+        }
+        ~MappedFile(){
+            if(m_data) munmap(const_cast<char*>(m_data), m_size);
+        }
+
+        MappedFile(const MappedFile&)               = delete;
+        MappedFile& operator=(const MappedFile&)    = delete;
+
+        const char *begin() const {return m_data;};
+        const char *end() const {return m_data + m_size;};
+
+    private:
+        const char *m_data = nullptr;
+        size_t m_size = 0;
+    };
+
+    // Hands out the lines of the file one at a time, numbered in input order
+    class LineQueue
+    {
+    public:
+        LineQueue(const MappedFile &t_file) : m_next{t_file.begin()}, m_end{t_file.end()} {};
+
+        bool pop(std::string &t_line, size_t &t_index){
+            std::lock_guard<std::mutex> lock(m_mutex);
+            if(m_next == m_end) return false;
+            const char *newline = std::find(m_next, m_end, '\n');
+            t_line.assign(m_next, newline);
+            t_index = m_index ++;
+            m_next = newline == m_end ? m_end : newline + 1;
+            return true;
+        }
+
+    private:
+        std::mutex m_mutex;
+        const char *m_next;
+        const char *m_end;
+        size_t m_index = 0;
+    };
+
+    // Results arrive in any order, each one is held back until all the lines before it have been written
+    class OrderedWriter
+    {
+    public:
+        OrderedWriter(std::ostream &os) : m_os{os} {};
+
+        void write(size_t t_index, std::string t_record){
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_pending.emplace(t_index, std::move(t_record));
+            bool written = false;
+            for(auto it = m_pending.begin(); it != m_pending.end() && it->first == m_next; it = m_pending.erase(it)){
+                if(!it->second.empty()) m_os << it->second << '\n';
+                m_next ++;
+                written = true;
+            }
+            if(written) m_os.flush();
+        }
+
+    private:
+        std::mutex m_mutex;
+        std::ostream &m_os;
+        std::map<size_t, std::string> m_pending;
+        size_t m_next = 0;
+    };
+
+    std::string jsonString(const std::string &t_text){
+        std::string quoted = "\"";
+        for(char c : t_text){
+            if(c == '"' || c == '\\') quoted += '\\';
+            if(static_cast<unsigned char>(c) >= 0x20) quoted += c;
+        }
+        return quoted + "\"";
+    }
+
+    // An epd line is the first four fen fields followed by operations such as bm Qd1+; id "WAC.001";
+    // a fen line also has the two move counters. Returns false for empty lines and comments
+    bool parsePosition(const std::string &t_line, std::string &t_fen, std::string &t_id){
+        std::istringstream stream(t_line);
+        std::string field;
+        t_fen.clear();
+        t_id.clear();
+        for(int i = 0; i < 6 && stream >> field; i ++){
+            bool isCounter = !field.empty() && std::all_of(field.begin(), field.end(),
+                [](unsigned char c){return std::isdigit(c);});
+            if(i == 0 && field[0] == '#') return false;
+            if(i >= 4 && !isCounter) break;
+            t_fen += (i > 0 ? " " : "") + field;
+        }
+        if(t_fen.empty()) return false;
+
+        size_t id = t_line.find(" id ");
+        if(id != std::string::npos){
+            size_t open = t_line.find('"', id), close = t_line.find('"', open + 1);
+            if(open != std::string::npos && close != std::string::npos) t_id = t_line.substr(open + 1, close - open - 1);
+        }
+        return true;
+    }
+
+    // Writes the json record of the position to t_record, returns false when the fen is invalid and the
+    // record only reports the error
+    bool analyze(Search &search, const std::string &t_fen, const std::string &t_id,
+        const SearchLimits &t_limits, std::string &t_record)
+    {
+        std::ostringstream record;
+        record << "{\"fen\":" << jsonString(t_fen);
+        if(!t_id.empty()) record << ",\"id\":" << jsonString(t_id);
+
+        // the board is parsed in place, no start position is set up just to be overwritten
+        std::optional<ChessBoard> parsed;
+        try {
+            parsed.emplace(t_fen);
+        }
+        catch(const std::invalid_argument &e){
+            record << ",\"error\":" << jsonString(e.what()) << "}";
+            t_record = record.str();
+            return false;
+        }
+        const ChessBoard &board = *parsed;
+
+        // clearing the whole table for every position would cost more than a shallow search, so the entries of
+        // earlier positions are only aged out by the new search; the history tables are small enough to reset
+        search.clearHistory();
+        auto start = std::chrono::steady_clock::now();
+        search.start(board, t_limits);
+        search.wait();
+        auto end = std::chrono::steady_clock::now();
+
+        ChessMove bestMove = search.getBestMove();
+        Score score = search.getScore();
+        if(bestMove == ChessMove() && board.isCheck()) score = matedIn(0);
+
+        record << ",\"bestmove\":\"" << (bestMove == ChessMove() ? std::string("0000") : bestMove.getNotation()) << "\"";
+        if(score >= MATE_BOUND) record << ",\"mate\":" << (CHECKMATE - score + 1) / 2;
+        else if(score <= -MATE_BOUND) record << ",\"mate\":" << -(CHECKMATE + score) / 2;
+        else record << ",\"cp\":" << score;
+        record << ",\"depth\":" << search.getStats().completedDepth << ",\"nodes\":" << search.getNodes()
+            << ",\"time_ms\":" << std::chrono::duration_cast<std::chrono::milliseconds>(end - start).count() << "}";
+        t_record = record.str();
+        return true;
+    }
+}
+
+void runBatch(const std::string &t_path, const SearchLimits &t_limits, int t_threads, size_t t_hashMegaBytes,
+    std::ostream &os, std::ostream &log)
+{
+    MappedFile file(t_path);
+    LineQueue lines(file);
+    OrderedWriter writer(os);
+
+    std::mutex totalsMutex;
+    uint64_t totalNodes = 0;
+    size_t totalPositions = 0;
+    size_t totalInvalid = 0;
+
+    auto work = [&](){
+        TranspositionTable table(t_hashMegaBytes);
+        Search search(table, [](const std::string&){});
+        uint64_t nodes = 0;
+        size_t positions = 0;
+        size_t invalid = 0;
+
+        std::string line, fen, id, record;
+        size_t index;
+        while(lines.pop(line, index)){
+            // skipped lines still take their turn in the output, as empty records that are not written
+            if(!parsePosition(line, fen, id)){
+                writer.write(index, std::string());
+                continue;
+            }
+            if(analyze(search, fen, id, t_limits, record)){
+                nodes += search.getNodes();
+                positions ++;
+            }
+            else invalid ++;
+            writer.write(index, std::move(record));
+        }
+
+        std::lock_guard<std::mutex> lock(totalsMutex);
+        totalNodes += nodes;
+        totalPositions += positions;
+        totalInvalid += invalid;
+    };
+
+    auto start = std::chrono::steady_clock::now();
+    std::vector<std::thread> workers;
+    for(int i = 0; i < t_threads; i ++) workers.emplace_back(work);
+    for(auto &worker : workers) worker.join();
+    auto end = std::chrono::steady_clock::now();
+
+    std::chrono::duration<double> elapsed = end - start;
+    double seconds = std::max(elapsed.count(), 1e-9);
+    log << totalPositions << " analyzed, " << totalInvalid << " invalid, on " << t_threads << " threads in " << seconds << "s, "
+        << totalPositions / seconds << " positions/s, " << uint64_t(totalNodes / seconds) << " nps" << std::endl;
+}
@@ -0,0 +1,17 @@
+#pragma once
+
+#include <cstddef>
+#include <iostream>
+#include <string>
+
+#include "TimeManager.h"
+
+// Analyzes every position of an EPD or FEN file, one per line, within the given depth, node or time budget.
+// The file is memory mapped and the positions are handed out to t_threads single threaded searches, each
+// with its own transposition table of t_hashMegaBytes, so the throughput grows with the number of cores.
+// A worker keeps its table from one position to the next, the entries of earlier positions are only aged,
+// so a result may depend on the positions its worker searched before it.
+// Every result is written to os as a json line, in the order of the input, and a summary goes to log.
+// Throws std::runtime_error when the file cannot be read
+void runBatch(const std::string &t_path, const SearchLimits &t_limits, int t_threads, size_t t_hashMegaBytes,
+    std::ostream &os, std::ostream &log);
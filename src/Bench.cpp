@@ -0,0 +1,207 @@
+#include "Bench.h"
+#include "ChessBoard.h"
+#include "LookupTables.h"
+#include "Network.h"
+#include "Search.h"
+#include "TranspositionTable.h"
+
+#include <chrono>
+#include <iomanip>
+#include <iterator>
+#include <vector>
+
+namespace
+{
+    const char *benchPositions[] = {
+        "rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1",
+        "r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - 0 1",
+        "r4rk1/1pp1qppp/p1np1n2/2b1p1B1/2B1P1b1/P1NP1N2/1PP1QPPP/R4RK1 w - - 0 10",
+        "8/2p5/3p4/KP5r/1R3p1k/8/4P1P1/8 w - - 0 1"
+    };
+
+    const int threadCounts[] = {1, 2, 4, 8, 16, 32};
+
+    struct TacticalTest
+    {
+        const char *fen;
+        const char *bestMove;
+    };
+
+    // the first positions of Win At Chess
+    const TacticalTest tacticalTests[] = {
+        {"2rr3k/pp3pp1/1nnqbN1p/3pN3/2pP4/2P3Q1/PPB4P/R4RK1 w - - 0 1", "g3g6"},
+        {"8/7p/5k2/5p2/p1p2P2/Pr1pPK2/1P1R3P/8 b - - 0 1", "b3b2"},
+        {"5rk1/1ppb3p/p1pb4/6q1/3P1p1r/2P1R2P/PP1BQ1P1/5RKN w - - 0 1", "e3g3"},
+        {"r1bq2rk/pp3pbp/2p1p1pQ/7P/3P4/2PB1N2/PP3PPR/2KR4 w - - 0 1", "h6h7"},
+        {"5k2/6pp/p1qN4/1p1p4/3P4/2PKP2Q/PP3r2/3R4 b - - 0 1", "c6c4"},
+        {"7k/p7/1R5K/6r1/6p1/6P1/8/8 w - - 0 1", "b6b7"},
+        {"rnbqkb1r/pppp1ppp/8/4P3/6n1/7P/PPPNPPP1/R1BQKBNR b KQkq - 0 1", "g4e3"},
+        {"r4q1k/p2bR1rp/2p2Q1N/5p2/5p2/2P5/PP3PPP/R5K1 w - - 0 1", "e7f7"},
+        {"3q1rk1/p4pp1/2pb3p/3p4/6Pr/1PNQ4/P1PB1PP1/4RRK1 b - - 0 1", "d6h2"},
+        {"2br2k1/2q3rn/p2NppQ1/2p1P3/Pp5R/4P3/1P3PPP/3R2K1 w - - 0 1", "h4h7"}
+    };
+
+    struct SliderQuery
+    {
+        uint64_t occupied;
+        int square;
+    };
+
+    template <typename Lookup>
+    double timeLookups(const std::vector<SliderQuery> &queries, int passes, uint64_t &checksum, Lookup lookup){
+        auto start = std::chrono::high_resolution_clock::now();
+        for(int pass = 0; pass < passes; pass ++)
+            for(const SliderQuery &query : queries) checksum += lookup(query.occupied, query.square);
+        auto end = std::chrono::high_resolution_clock::now();
+
+        // an empty asm reading the checksum keeps the compiler from dropping the lookups when it is not compared
+        asm volatile("" : : "r"(checksum));
+        std::chrono::duration<double> elapsed = end - start;
+        return elapsed.count();
+    }
+}
+
+void runSearchBenchmark(std::ostream &os, int t_depth, size_t t_hashMegaBytes, const SearchFeatures &t_features)
+{
+    TranspositionTable table(t_hashMegaBytes);
+    Search search(table, [](const std::string&){});
+    search.setFeatures(t_features);
+    SearchLimits limits;
+    limits.depth = t_depth;
+
+    uint64_t totalNodes = 0;
+    double totalTime = 0;
+    for(const char *fen : benchPositions){
+        table.clear();
+        search.clearHistory();
+        auto start = std::chrono::high_resolution_clock::now();
+        search.start(ChessBoard(fen), limits);
+        search.wait();
+        auto end = std::chrono::high_resolution_clock::now();
+        std::chrono::duration<double> elapsed = end - start;
+
+        uint64_t nodes = search.getNodes();
+        totalNodes += nodes;
+        totalTime += elapsed.count();
+        os << std::left << std::setw(80) << fen << std::right << std::setw(12) << nodes << " nodes" << std::fixed
+            << std::setprecision(3) << std::setw(9) << elapsed.count() << "s  first move cutoffs "
+            << std::setprecision(1) << 100 * search.firstMoveCutoffRate() << "%  ebf "
+            << std::setprecision(2) << search.getStats().branchingFactor(t_depth) << std::endl;
+    }
+    os << "total " << totalNodes << " nodes to depth " << t_depth << " in " << std::setprecision(3) << totalTime << "s, "
+        << uint64_t(totalNodes / totalTime) << " nps" << std::endl;
+}
+
+void runSmpBenchmark(std::ostream &os, int t_depth, size_t t_hashMegaBytes)
+{
+    TranspositionTable table(t_hashMegaBytes);
+    Search search(table, [](const std::string&){});
+    SearchLimits limits;
+    limits.depth = t_depth;
+
+    double singleThreadTime = 0;
+    for(int threads : threadCounts){
+        search.setThreads(threads);
+        uint64_t nodes = 0;
+        double time = 0;
+
+        for(const char *fen : benchPositions){
+            table.clear();
+            auto start = std::chrono::high_resolution_clock::now();
+            search.start(ChessBoard(fen), limits);
+            search.wait();
+            auto end = std::chrono::high_resolution_clock::now();
+            std::chrono::duration<double> elapsed = end - start;
+
+            nodes += search.getNodes();
+            time += elapsed.count();
+        }
+
+        if(threads == 1) singleThreadTime = time;
+        os << std::setw(3) << threads << " threads  depth " << t_depth << std::fixed << std::setprecision(3)
+            << std::setw(10) << time << "s" << std::setw(14) << nodes << " nodes" << std::setw(12) << uint64_t(nodes / time) << " nps"
+            << "  speedup " << std::setprecision(2) << singleThreadTime / time << std::endl;
+    }
+}
+
+void runNnueBenchmark(std::ostream &os, int t_depth, size_t t_hashMegaBytes, const Network *t_network)
+{
+    TranspositionTable table(t_hashMegaBytes);
+    Search search(table, [](const std::string&){});
+    SearchLimits limits;
+    limits.depth = t_depth;
+    const Network *active = Network::getActive();
+
+    // the boards pick the evaluation when they are set up, from the network active at that moment
+    for(const Network *network : {static_cast<const Network*>(nullptr), t_network}){
+        Network::setActive(network);
+        uint64_t nodes = 0;
+        double time = 0;
+        for(const char *fen : benchPositions){
+            table.clear();
+            search.clearHistory();
+            auto start = std::chrono::high_resolution_clock::now();
+            search.start(ChessBoard(fen), limits);
+            search.wait();
+            auto end = std::chrono::high_resolution_clock::now();
+            std::chrono::duration<double> elapsed = end - start;
+            nodes += search.getNodes();
+            time += elapsed.count();
+        }
+
+        int solved = 0;
+        for(const TacticalTest &test : tacticalTests){
+            table.clear();
+            search.clearHistory();
+            search.start(ChessBoard(test.fen), limits);
+            search.wait();
+            solved += search.getBestMove().getNotation() == test.bestMove;
+        }
+
+        std::string name = network ? std::string("nnue (") + Network::kernelName() + ")" : std::string("psqt");
+        os << std::left << std::setw(12) << name << std::right << " depth " << t_depth << std::setw(12) << nodes << " nodes"
+            << std::fixed << std::setprecision(3) << std::setw(9) << time << "s" << std::setw(10) << uint64_t(nodes / time)
+            << " nps  solved " << solved << "/" << std::size(tacticalTests) << std::endl;
+    }
+    Network::setActive(active);
+}
+
+void runSliderBenchmark(std::ostream &os)
+{
+    const LookupTables &lookup = LookupTables::getInstance();
+    const int passes = 200;
+
+    // xorshift keeps the occupancies identical from run to run, anding two of them gives about 16 pieces
+    std::vector<SliderQuery> queries(1 << 16);
+    uint64_t state = 0x9e3779b97f4a7c15;
+    auto next = [&state](){
+        state ^= state << 13;
+        state ^= state >> 7;
+        state ^= state << 17;
+        return state;
+    };
+    for(SliderQuery &query : queries){
+        query.occupied = next() & next() & next();
+        query.square = next() % 64;
+    }
+    double lookups = double(queries.size()) * passes * 2;
+
+    uint64_t magicSum = 0;
+    double magicTime = timeLookups(queries, passes, magicSum, [&lookup](uint64_t occupied, int square){
+        return lookup.rookAttacksMagic(occupied, square) ^ lookup.bishopAttacksMagic(occupied, square);
+    });
+    os << "magic " << std::fixed << std::setprecision(3) << magicTime << "s, "
+        << std::setprecision(2) << magicTime * 1e9 / lookups << " ns per lookup" << std::endl;
+
+#ifdef USE_PEXT
+    uint64_t pextSum = 0;
+    double pextTime = timeLookups(queries, passes, pextSum, [&lookup](uint64_t occupied, int square){
+        return lookup.rookAttacksPext(occupied, square) ^ lookup.bishopAttacksPext(occupied, square);
+    });
+    os << "pext  " << std::fixed << std::setprecision(3) << pextTime << "s, "
+        << std::setprecision(2) << pextTime * 1e9 / lookups << " ns per lookup, "
+        << magicTime / pextTime << "x the magic speed" << (pextSum == magicSum ? "" : ", MISMATCH") << std::endl;
+#else
+    os << "pext  not compiled in, it needs BMI2 (-march=x86-64-v3)" << std::endl;
+#endif
+}
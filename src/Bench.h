@@ -0,0 +1,23 @@
+#pragma once
+
+#include <cstddef>
+#include <iostream>
+
+#include "Network.h"
+#include "Search.h"
+
+// Searches a few positions to a fixed depth on one thread from empty tables and reports the nodes needed to
+// reach the depth and the first move cutoff rate, the figures that tell whether move ordering improved
+void runSearchBenchmark(std::ostream &os, int t_depth, size_t t_hashMegaBytes, const SearchFeatures &t_features);
+
+// Searches a few positions to a fixed depth with 1, 2, 4, 8, 16 and 32 threads, starting from an empty
+// transposition table each time, and reports the time to depth and the speedup over a single thread
+void runSmpBenchmark(std::ostream &os, int t_depth, size_t t_hashMegaBytes);
+
+// Runs the positions of runSearchBenchmark and a few tactical tests to a fixed depth with the piece-square
+// evaluation and then with t_network, reporting the speed of each and how many tests their best move solves
+void runNnueBenchmark(std::ostream &os, int t_depth, size_t t_hashMegaBytes, const Network *t_network);
+
+// Times rook and bishop attack lookups on random occupancies with the magic multiplication tables and,
+// when compiled with BMI2, with the PEXT tables, checking that both return the same attacks
+void runSliderBenchmark(std::ostream &os);
@@ -2,159 +2,199 @@
 
 #include <cassert>
 #include <algorithm>
+#include <cctype>
+#include <sstream>
+#include <stdexcept>
+#include <type_traits>
 #include <unordered_map>
+#include <vector>
 
 #include "utils.h"
 #include "notation.h"
 #include "Evaluation.h"
+#include "Zobrist.h"
 
-ChessBoard::ChessBoard() : m_sideToMove(white), m_lookup {LookupTables::getInstance()}, m_nonPawnPieces{0}
-{
-    m_posHistory.emplace_back(PosInfo());
-    initBoard();
-    m_kingSquare[white] = btw::bitScanForward(m_bitBoard[white] & m_bitBoard[kings]);
-    m_kingSquare[black] = btw::bitScanForward(m_bitBoard[black] & m_bitBoard[kings]);
-    for (int pieces = knights; pieces <= kings; pieces ++) m_nonPawnPieces += btw::popCount(m_bitBoard[pieces]) * mgValue[pieces - 2];
-}
-
-ChessBoard::ChessBoard(const ChessBoard &t_other) :  
-    m_sideToMove{
-        t_other.m_sideToMove
-    },  
-    m_kingSquare{
-        t_other.m_kingSquare[0], t_other.m_kingSquare[1]
-    },
-    m_bitBoard{
-        t_other.m_bitBoard[0], t_other.m_bitBoard[1], t_other.m_bitBoard[2], t_other.m_bitBoard[3],
-        t_other.m_bitBoard[4], t_other.m_bitBoard[5], t_other.m_bitBoard[6], t_other.m_bitBoard[7]
-    },
-    m_lookup {
-        LookupTables::getInstance()
-    },
-    m_nonPawnPieces{
-        t_other.m_nonPawnPieces
-    }
+// without a network copies stay cheap and allocation free: everything but the empty accumulator stack is
+// inline plain data, and the accumulators themselves live on the heap so they never add to the board size
+static_assert(sizeof(ChessBoard) < 16 * 1024);
+
+ChessBoard::ChessBoard() : ChessBoard("rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1")
 {
-    m_posHistory.reserve(1);
-    m_posHistory.emplace_back(t_other.m_posHistory.back());
 }
 
-ChessBoard& ChessBoard::operator=(const ChessBoard &other)
+ChessBoard::ChessBoard(const std::string &t_fen) : m_sideToMove(white), m_nonPawnPieces{0, 0}, m_lookup {&LookupTables::getInstance()},
+    m_network{Network::getActive()}
 {
-    if(this != &other){
-        std::copy(std::begin(other.m_bitBoard), std::end(other.m_bitBoard), std::begin(m_bitBoard));
-        std::copy(std::begin(other.m_kingSquare), std::end(other.m_kingSquare), std::begin(m_kingSquare));
-        m_posHistory.emplace_back(other.m_posHistory.back());
-        m_nonPawnPieces = other.m_nonPawnPieces;
-        m_sideToMove = other.m_sideToMove;
+    if (m_network) m_accumulators.allocate();
+    std::istringstream stream(t_fen);
+    std::vector<std::string> fields;
+    for (std::string field; stream >> field;) fields.push_back(field);
+
+    if (fields.size() < 2 || fields.size() > 6 || (fields[1] != "w" && fields[1] != "b"))
+        throw std::invalid_argument("invalid FEN: " + t_fen);
+    fields.resize(6);
+
+    std::fill(std::begin(m_bitBoard), std::end(m_bitBoard), 0);
+    int rank = 7, file = 0;
+    for (char c : fields[0]){
+        if (c == '/'){
+            if (file != 8 || rank == 0) throw std::invalid_argument("invalid FEN: " + t_fen);
+            rank --;
+            file = 0;
+        }
+        else if (c >= '1' && c <= '8') file += c - '0';
+        else {
+            const std::string pieceChars = "pnbrqk";
+            size_t piece = pieceChars.find(std::tolower(c));
+            if (piece == std::string::npos || file > 7) throw std::invalid_argument("invalid FEN: " + t_fen);
+            uint64_t squareMask = (uint64_t) 1 << (rank * 8 + file);
+            m_bitBoard[pawns + piece] |= squareMask;
+            m_bitBoard[std::isupper(c) ? white : black] |= squareMask;
+            file ++;
+        }
+        if (file > 8) throw std::invalid_argument("invalid FEN: " + t_fen);
+    }
+    // pawns never stand on the first or last rank
+    if (rank != 0 || file != 8 || btw::popCount(m_bitBoard[kings] & m_bitBoard[white]) != 1
+        || btw::popCount(m_bitBoard[kings] & m_bitBoard[black]) != 1 || (m_bitBoard[pawns] & 0xff000000000000ff))
+        throw std::invalid_argument("invalid FEN: " + t_fen);
+
+    // the side that just moved cannot have left its king in check, move generation would capture it
+    m_sideToMove = fields[1] == "w" ? white : black;
+    if (isSquareAttacked(btw::bitScanForward(m_bitBoard[kings] & m_bitBoard[1 - m_sideToMove]), m_sideToMove))
+        throw std::invalid_argument("invalid FEN: " + t_fen);
+
+    // rights are only kept when king and rook are still on their starting squares
+    PosInfo info;
+    const std::string castling = fields[2].empty() ? "-" : fields[2];
+    uint64_t whiteRooks = m_bitBoard[white] & m_bitBoard[rooks], blackRooks = m_bitBoard[black] & m_bitBoard[rooks];
+    bool whiteKingHome = (m_bitBoard[white] & m_bitBoard[kings]) & ((uint64_t) 1 << e1);
+    bool blackKingHome = (m_bitBoard[black] & m_bitBoard[kings]) & ((uint64_t) 1 << e8);
+    if (castling.find('K') == std::string::npos || !whiteKingHome || !(whiteRooks & ((uint64_t) 1 << h1))) info.removeShortCastlingRights(white);
+    if (castling.find('Q') == std::string::npos || !whiteKingHome || !(whiteRooks & ((uint64_t) 1 << a1))) info.removeLongCastlingRights(white);
+    if (castling.find('k') == std::string::npos || !blackKingHome || !(blackRooks & ((uint64_t) 1 << h8))) info.removeShortCastlingRights(black);
+    if (castling.find('q') == std::string::npos || !blackKingHome || !(blackRooks & ((uint64_t) 1 << a8))) info.removeLongCastlingRights(black);
+
+    // FEN gives the square behind the pawn, PosInfo the square of the pawn itself. Like the castling rights
+    // it is only kept when the double push could have happened: an enemy pawn in front of an empty target
+    // square, with the square it came from empty too
+    const std::string epSquare = fields[3].empty() ? "-" : fields[3];
+    if (epSquare != "-"){
+        if (epSquare.size() != 2 || epSquare[0] < 'a' || epSquare[0] > 'h' || epSquare[1] != (m_sideToMove == white ? '6' : '3'))
+            throw std::invalid_argument("invalid FEN: " + t_fen);
+        int target = (epSquare[1] - '1') * 8 + (epSquare[0] - 'a');
+        int pawnSquare = m_sideToMove == white ? target - 8 : target + 8;
+        int originSquare = m_sideToMove == white ? target + 8 : target - 8;
+        uint64_t occupied = m_bitBoard[white] | m_bitBoard[black];
+        uint64_t enemyPawns = m_bitBoard[pawns] & m_bitBoard[1 - m_sideToMove];
+        if ((enemyPawns & ((uint64_t) 1 << pawnSquare)) && !(occupied & ((uint64_t) 1 << target))
+            && !(occupied & ((uint64_t) 1 << originSquare))){
+            info.setEpState(true);
+            info.setEpSquare(pawnSquare);
+        }
+    }
+
+    try {
+        info.setHalfmoveClock(fields[4].empty() ? 0 : std::stoi(fields[4]));
+        int fullmoveNumber = fields[5].empty() ? 1 : std::stoi(fields[5]);
+        m_gamePly = 2 * std::max(fullmoveNumber - 1, 0) + m_sideToMove;
+    }
+    catch (const std::logic_error &) {
+        throw std::invalid_argument("invalid FEN: " + t_fen);
     }
 
-    return *this;
+    m_firstPly = m_gamePly;
+    state().posInfo = info;
+    initState();
 }
 
 bool ChessBoard::operator==(const ChessBoard &t_other) const
 {
     return m_sideToMove == t_other.m_sideToMove 
         && std::equal(std::begin(m_bitBoard), std::end(m_bitBoard), std::begin(t_other.m_bitBoard), std::end(t_other.m_bitBoard))
-        && m_posHistory.back().getInfo() == t_other.m_posHistory.back().getInfo();
+        && state().posInfo.getInfo() == t_other.state().posInfo.getInfo();
 }
 
-bool ChessBoard::isIllegal()
+void ChessBoard::generateCaptures(MoveList &t_moveList)
 {
-    return isCheck(m_sideToMove);
-}
-
-bool ChessBoard::isLegal()
-{
-    return !isIllegal();
-}
-
-std::vector<ChessMove> ChessBoard::getCaptures()
-{
-    std::vector<ChessMove> moveList;
-    moveList.reserve(256); // over the maximum number of moves possible for any legal position
-
-    uint64_t pawnsSet = m_bitBoard[pawns] & m_bitBoard[m_sideToMove];
     uint64_t enemyPcs = m_bitBoard[1 - m_sideToMove];
-
-    generatePawnsCaptures(moveList, pawnsSet, enemyPcs);
-    if(m_posHistory.back().isEpPossible())
-        generateEpCaptures(moveList, pawnsSet, m_posHistory.back().getEpSquare());
-    generatePieceCaptures(knights, moveList);
-    generatePieceCaptures(bishops, moveList);
-    generatePieceCaptures(rooks, moveList);
-    generatePieceCaptures(queens, moveList);
-    generatePieceCaptures(kings, moveList);
-    
-    return moveList;
+    uint64_t checkers = state().checkers;
+
+    // in double check only the king can move
+    if ((checkers & (checkers - 1)) == 0){
+        uint64_t evasions = evasionTargets();
+        uint64_t targets = enemyPcs & evasions;
+        uint64_t promoTargets = ~(m_bitBoard[black] | m_bitBoard[white]) & evasions;
+        uint64_t pawnsSet = m_bitBoard[pawns] & m_bitBoard[m_sideToMove];
+        uint64_t pinnedPawns = pawnsSet & state().pinned;
+
+        generatePawnsCaptures(t_moveList, pawnsSet ^ pinnedPawns, targets);
+        generateQueenPromotions(t_moveList, pawnsSet ^ pinnedPawns, promoTargets);
+        if (pinnedPawns) do {
+            int square = btw::bitScanForward(pinnedPawns);
+            uint64_t pinLine = m_lookup->line(m_kingSquare[m_sideToMove], square);
+            generatePawnsCaptures(t_moveList, (uint64_t) 1 << square, targets & pinLine);
+            generateQueenPromotions(t_moveList, (uint64_t) 1 << square, promoTargets & pinLine);
+        } while (pinnedPawns &= (pinnedPawns - 1));
+        if(state().posInfo.isEpPossible())
+            generateEpCaptures(t_moveList, pawnsSet, state().posInfo.getEpSquare());
+        generatePieceMoves(knights, t_moveList, targets, capture);
+        generatePieceMoves(bishops, t_moveList, targets, capture);
+        generatePieceMoves(rooks, t_moveList, targets, capture);
+        generatePieceMoves(queens, t_moveList, targets, capture);
+    }
+    generatePieceMoves(kings, t_moveList, enemyPcs & safeKingSquares(), capture);
 }
 
-std::vector<ChessMove> ChessBoard::getQuiets()
+void ChessBoard::generateQuiets(MoveList &t_moveList)
 {
-    std::vector<ChessMove> moveList;
-    moveList.reserve(256); // over the maximum number of moves possible for any legal position
-
-    uint64_t pawnsSet = m_bitBoard[pawns] & m_bitBoard[m_sideToMove];
     uint64_t emptySet = ~ (m_bitBoard[black] | m_bitBoard[white]);
+    uint64_t checkers = state().checkers;
 
+    generatePieceMoves(kings, t_moveList, emptySet & safeKingSquares(), quiet);
+    if (checkers & (checkers - 1)) return;
 
-    generatePieceQuiets(kings, moveList);
-    generatePieceQuiets(knights, moveList);
-    generatePawnsPushes(moveList, pawnsSet, emptySet);
-    generateDoublePushes(moveList, pawnsSet, emptySet);
-    generatePieceQuiets(bishops, moveList);
-    generatePieceQuiets(rooks, moveList);
-    generatePieceQuiets(queens, moveList);
-    generateCastles(moveList);
-
-    return moveList;
-}
-
-void ChessBoard::generatePieceCaptures(int t_pieceType, std::vector<ChessMove> &t_moveList)
-{
-    uint64_t pieceSet = m_bitBoard[t_pieceType] & m_bitBoard[m_sideToMove];
-    uint64_t occupiedSquares = m_bitBoard[black] | m_bitBoard[white];
-    uint64_t emptySquares = ~occupiedSquares;
-    uint64_t enemyPieces = m_bitBoard[1 - m_sideToMove];
-    
-    if (pieceSet) do {
-        int startingSquare = btw::bitScanForward(pieceSet);
-        uint64_t attackSet = getAttackSet(t_pieceType, occupiedSquares, startingSquare);
-
-        //serialize all captures moves
-        uint64_t captures = attackSet & enemyPieces;
-        if (captures) do {
-            int endSquare = btw::bitScanForward(captures);
-            t_moveList.emplace_back(
-                ChessMove(t_pieceType, startingSquare, endSquare, capture, capturedPiece(endSquare))
-            );
-        } while (captures &= (captures -1 ));
-    } while (pieceSet &= (pieceSet - 1));
+    uint64_t targets = emptySet & evasionTargets();
+    uint64_t pawnsSet = m_bitBoard[pawns] & m_bitBoard[m_sideToMove];
+    uint64_t pinnedPawns = pawnsSet & state().pinned;
+
+    generatePieceMoves(knights, t_moveList, targets, quiet);
+    generatePawnsPushes(t_moveList, pawnsSet ^ pinnedPawns, targets);
+    generateDoublePushes(t_moveList, pawnsSet ^ pinnedPawns, emptySet, targets);
+    if (pinnedPawns) do {
+        int square = btw::bitScanForward(pinnedPawns);
+        uint64_t pinLine = m_lookup->line(m_kingSquare[m_sideToMove], square);
+        generatePawnsPushes(t_moveList, (uint64_t) 1 << square, targets & pinLine);
+        generateDoublePushes(t_moveList, (uint64_t) 1 << square, emptySet, targets & pinLine);
+    } while (pinnedPawns &= (pinnedPawns - 1));
+    generatePieceMoves(bishops, t_moveList, targets, quiet);
+    generatePieceMoves(rooks, t_moveList, targets, quiet);
+    generatePieceMoves(queens, t_moveList, targets, quiet);
+    if (!checkers) generateCastles(t_moveList);
 }
 
-void ChessBoard::generatePieceQuiets(int t_pieceType, std::vector<ChessMove> &t_moveList)
+// Pinned pieces may only slide along the line through their king, so a pinned knight never moves
+void ChessBoard::generatePieceMoves(int t_pieceType, MoveList &t_moveList, uint64_t t_targets, int t_flags)
 {
     uint64_t pieceSet = m_bitBoard[t_pieceType] & m_bitBoard[m_sideToMove];
     uint64_t occupiedSquares = m_bitBoard[black] | m_bitBoard[white];
-    uint64_t emptySquares = ~occupiedSquares;
-    uint64_t enemyPieces = m_bitBoard[1 - m_sideToMove];
+    int kingSquare = m_kingSquare[m_sideToMove];
 
     if (pieceSet) do {
         int startingSquare = btw::bitScanForward(pieceSet);
-        uint64_t attackSet = getAttackSet(t_pieceType, occupiedSquares, startingSquare);
+        uint64_t moves = getAttackSet(t_pieceType, occupiedSquares, startingSquare) & t_targets;
+        if (state().pinned & ((uint64_t) 1 << startingSquare)) moves &= m_lookup->line(kingSquare, startingSquare);
 
-        //serialize all non-capture moves
-        uint64_t quietMoves    = attackSet & emptySquares;
-        if (quietMoves) do {
-            int endSquare = btw::bitScanForward(quietMoves);
+        if (moves) do {
+            int endSquare = btw::bitScanForward(moves);
             t_moveList.emplace_back(
-                ChessMove(t_pieceType, startingSquare, endSquare, quiet)
+                ChessMove(t_pieceType, startingSquare, endSquare, t_flags, t_flags == capture ? capturedPiece(endSquare) : 0)
             );
-        } while (quietMoves &= (quietMoves -1 ));
+        } while (moves &= (moves - 1));
     } while (pieceSet &= (pieceSet - 1));
 }
 
-void ChessBoard::generatePawnsPushes(std::vector<ChessMove> &t_moveList, 
+void ChessBoard::generatePawnsPushes(MoveList &t_moveList, 
     uint64_t t_pawnsSet, uint64_t t_emptySet)
 {
     const uint64_t row8 = (uint64_t) 0xff00000000000000;
@@ -182,19 +222,27 @@ void ChessBoard::generatePawnsPushes(std::vector<ChessMove> &t_moveList,
     if (promoSet) do {
         int endSq = btw::bitScanForward(promoSet);
         int startSq = endSq + offset;
-        t_moveList.insert(
-            t_moveList.end(),
-            {
-                ChessMove(pawns, startSq, endSq, knightPromo),
-                ChessMove(pawns, startSq, endSq, bishopPromo),
-                ChessMove(pawns, startSq, endSq, rookPromo),
-                ChessMove(pawns, startSq, endSq, queenPromo) 
-            }
-        );
+        t_moveList.emplace_back(ChessMove(pawns, startSq, endSq, knightPromo));
+        t_moveList.emplace_back(ChessMove(pawns, startSq, endSq, bishopPromo));
+        t_moveList.emplace_back(ChessMove(pawns, startSq, endSq, rookPromo));
     } while (promoSet &= (promoSet - 1));
 }
 
-void ChessBoard::generatePawnsCaptures(std::vector<ChessMove> &t_moveList,
+// A queen promotion gains as much material as most captures, so it is generated with them
+void ChessBoard::generateQueenPromotions(MoveList &t_moveList, uint64_t t_pawnsSet, uint64_t t_emptySet)
+{
+    const uint64_t row8 = (uint64_t) 0xff00000000000000;
+    const uint64_t row1 = (uint64_t) 0x00000000000000ff;
+    uint64_t promoSet = m_sideToMove == white ? (t_pawnsSet << 8 & t_emptySet) & row8 : (t_pawnsSet >> 8 & t_emptySet) & row1;
+    int offset = m_sideToMove == white ? -8 : 8;
+
+    if (promoSet) do {
+        int endSq = btw::bitScanForward(promoSet);
+        t_moveList.emplace_back(ChessMove(pawns, endSq + offset, endSq, queenPromo));
+    } while (promoSet &= (promoSet - 1));
+}
+
+void ChessBoard::generatePawnsCaptures(MoveList &t_moveList,
     uint64_t t_pawnsSet, uint64_t t_enemyPcs)
 {
     const uint64_t row8 = (uint64_t) 0xff00000000000000;
@@ -239,43 +287,33 @@ void ChessBoard::generatePawnsCaptures(std::vector<ChessMove> &t_moveList,
         int endSq = btw::bitScanForward(eastPromoCaptures);
         int startSq = endSq + eastOffset;
         int captured = capturedPiece(endSq);
-        t_moveList.insert(
-            t_moveList.end(),
-            {
-                ChessMove(pawns, startSq, endSq, knightPromoCapture, captured),
-                ChessMove(pawns, startSq, endSq, bishopPromoCapture, captured),
-                ChessMove(pawns, startSq, endSq, rookPromoCapture, captured),
-                ChessMove(pawns, startSq, endSq, queenPromoCapture, captured) 
-            }
-        );
+        t_moveList.emplace_back(ChessMove(pawns, startSq, endSq, knightPromoCapture, captured));
+        t_moveList.emplace_back(ChessMove(pawns, startSq, endSq, bishopPromoCapture, captured));
+        t_moveList.emplace_back(ChessMove(pawns, startSq, endSq, rookPromoCapture, captured));
+        t_moveList.emplace_back(ChessMove(pawns, startSq, endSq, queenPromoCapture, captured));
     } while (eastPromoCaptures &= (eastPromoCaptures - 1));
 
     if (westPromoCaptures) do {
         int endSq = btw::bitScanForward(westPromoCaptures);
         int startSq = endSq + westOffset;
         int captured = capturedPiece(endSq);
-        t_moveList.insert(
-            t_moveList.end(),
-            {
-                ChessMove(pawns, startSq, endSq, knightPromoCapture, captured),
-                ChessMove(pawns, startSq, endSq, bishopPromoCapture, captured),
-                ChessMove(pawns, startSq, endSq, rookPromoCapture, captured),
-                ChessMove(pawns, startSq, endSq, queenPromoCapture, captured) 
-            }
-        );
+        t_moveList.emplace_back(ChessMove(pawns, startSq, endSq, knightPromoCapture, captured));
+        t_moveList.emplace_back(ChessMove(pawns, startSq, endSq, bishopPromoCapture, captured));
+        t_moveList.emplace_back(ChessMove(pawns, startSq, endSq, rookPromoCapture, captured));
+        t_moveList.emplace_back(ChessMove(pawns, startSq, endSq, queenPromoCapture, captured));
     } while (westPromoCaptures &= (westPromoCaptures - 1));
 }
 
 
-void ChessBoard::generateDoublePushes(std::vector<ChessMove> &t_moveList, 
-    uint64_t t_pawnSet, uint64_t t_emptySquares)
+void ChessBoard::generateDoublePushes(MoveList &t_moveList, 
+    uint64_t t_pawnSet, uint64_t t_emptySquares, uint64_t t_targets)
 {
     const uint64_t rank4 = (uint64_t) 0x00000000ff000000;
     const uint64_t rank5 = (uint64_t) 0x000000ff00000000;
 
     if (m_sideToMove == white) {
         uint64_t pawnDoublePush = (t_pawnSet << 8) & t_emptySquares;
-        pawnDoublePush = (pawnDoublePush << 8) & t_emptySquares & rank4;
+        pawnDoublePush = (pawnDoublePush << 8) & t_emptySquares & rank4 & t_targets;
 
         if (pawnDoublePush) do {
             int endSquare = btw::bitScanForward(pawnDoublePush);
@@ -285,7 +323,7 @@ void ChessBoard::generateDoublePushes(std::vector<ChessMove> &t_moveList,
     }
     else {
         uint64_t pawnDoublePush = (t_pawnSet >> 8) & t_emptySquares;
-        pawnDoublePush = (pawnDoublePush >> 8) & t_emptySquares & rank5;
+        pawnDoublePush = (pawnDoublePush >> 8) & t_emptySquares & rank5 & t_targets;
 
         if (pawnDoublePush) do {
             int endSquare = btw::bitScanForward(pawnDoublePush);
@@ -295,7 +333,7 @@ void ChessBoard::generateDoublePushes(std::vector<ChessMove> &t_moveList,
     }
 }
 
-void ChessBoard::generateEpCaptures(std::vector<ChessMove> &t_moveList, uint64_t t_pawnsSet, int t_epSquare)
+void ChessBoard::generateEpCaptures(MoveList &t_moveList, uint64_t t_pawnsSet, int t_epSquare)
 {
     int endSquare;
     uint64_t epMask = (uint64_t) 1 << t_epSquare;
@@ -303,14 +341,14 @@ void ChessBoard::generateEpCaptures(std::vector<ChessMove> &t_moveList, uint64_t
     if (m_sideToMove == white) endSquare = t_epSquare + 8;     
     else endSquare = t_epSquare - 8;
 
-    if(btw::cpyWrapEast(epMask) & t_pawnsSet)
+    if((btw::cpyWrapEast(epMask) & t_pawnsSet) && isLegalEp(t_epSquare + 1, t_epSquare))
         t_moveList.emplace_back(ChessMove(pawns, t_epSquare + 1, endSquare, enPassant, pawns));
 
-    if(btw::cpyWrapWest(epMask) & t_pawnsSet)
+    if((btw::cpyWrapWest(epMask) & t_pawnsSet) && isLegalEp(t_epSquare - 1, t_epSquare))
         t_moveList.emplace_back(ChessMove(pawns, t_epSquare - 1, endSquare, enPassant, pawns));
 }
 
-void ChessBoard::generateCastles(std::vector<ChessMove> &t_moveList)
+void ChessBoard::generateCastles(MoveList &t_moveList)
 {
     uint64_t occupied = (m_bitBoard[black] | m_bitBoard[white]);
     uint64_t emptySet = ~occupied;
@@ -320,7 +358,7 @@ void ChessBoard::generateCastles(std::vector<ChessMove> &t_moveList)
         const uint64_t shortCastleSquares = (uint64_t) 0x0000000000000060;
         uint64_t intersection = longCastleSquares & emptySet;
         if(
-            m_posHistory.back().getLongCastlingRights(white) &&
+            state().posInfo.getLongCastlingRights(white) &&
             (intersection == longCastleSquares) &&
             ! isSquareAttacked(occupied, c1, black) &&
             ! isSquareAttacked(occupied, d1, black) &&
@@ -329,7 +367,7 @@ void ChessBoard::generateCastles(std::vector<ChessMove> &t_moveList)
         
         intersection = shortCastleSquares & emptySet; 
         if(
-            m_posHistory.back().getShortCastlingRights(white) &&
+            state().posInfo.getShortCastlingRights(white) &&
             (intersection == shortCastleSquares) &&
             ! isSquareAttacked(occupied, e1, black) &&
             ! isSquareAttacked(occupied, f1, black) &&
@@ -341,7 +379,7 @@ void ChessBoard::generateCastles(std::vector<ChessMove> &t_moveList)
         const uint64_t shortCastleSquares = (uint64_t) 0x6000000000000000;
         uint64_t intersection = longCastleSquares & emptySet; 
         if(
-            m_posHistory.back().getLongCastlingRights(black) &&
+            state().posInfo.getLongCastlingRights(black) &&
             (intersection == longCastleSquares) &&
             ! isSquareAttacked(occupied, c8, white) &&
             ! isSquareAttacked(occupied, d8, white) &&
@@ -350,7 +388,7 @@ void ChessBoard::generateCastles(std::vector<ChessMove> &t_moveList)
 
         intersection = shortCastleSquares & emptySet;
         if(
-            m_posHistory.back().getShortCastlingRights(black) &&
+            state().posInfo.getShortCastlingRights(black) &&
             (intersection == shortCastleSquares) &&
             ! isSquareAttacked(occupied, e8, white) &&
             ! isSquareAttacked(occupied, f8, white) &&
@@ -359,23 +397,98 @@ void ChessBoard::generateCastles(std::vector<ChessMove> &t_moveList)
     }
 }
 
-std::vector<uint64_t> ChessBoard::getBitBoards() const
+int ChessBoard::getGamePhase() const
 {
-    return std::vector<uint64_t>(m_bitBoard, m_bitBoard + 8);
+    const int mgMax = 6766, egMin = 1630;
+
+    int npm = std::max(egMin, std::min(mgMax, m_nonPawnPieces[white] + m_nonPawnPieces[black]));
+
+    return (npm - egMin) * MAX_PHASE / (mgMax - egMin);
 }
 
-float ChessBoard::getGamePhase()
+// Rebuilds the full move from its 16 bits packed form (as stored in the transposition table),
+// returns false if it is not legal in the current position, as after a key collision
+bool ChessBoard::decodeMove(uint16_t t_move, ChessMove &t_out)
 {
-    const int mgMax = 6766, egMin = 1630;
+    const uint64_t lastRank = m_sideToMove == white ? (uint64_t) 0xff00000000000000 : (uint64_t) 0x00000000000000ff;
+    int endSquare = t_move & 0x3f;
+    int startingSquare = (t_move >> 6) & 0x3f;
+    int flags = (t_move >> 12) & 0x0f;
+    uint64_t fromMask = (uint64_t) 1 << startingSquare;
+    uint64_t toMask = (uint64_t) 1 << endSquare;
+    uint64_t occupied = m_bitBoard[white] | m_bitBoard[black];
+
+    if(!(fromMask & m_bitBoard[m_sideToMove]) || (toMask & m_bitBoard[m_sideToMove])) return false;
+
+    int piece = pawns;
+    while(!(m_bitBoard[piece] & fromMask)) piece ++;
+
+    int captured = capturedPiece(endSquare);
+    bool isCapture = (flags & capture) != 0;
+    if(flags != enPassant && isCapture != ((toMask & m_bitBoard[1 - m_sideToMove]) != 0)) return false;
+    if(isCapture && flags != enPassant && captured == 8) return false; // kings can't be captured
+
+    if(flags == enPassant) captured = pawns;
+    ChessMove move(piece, startingSquare, endSquare, flags, isCapture ? captured : 0);
+    bool valid = false;
 
-    int npm = std::max(egMin, std::min(mgMax, m_nonPawnPieces));
+    switch (flags)
+    {
+    case quiet:
+    case capture:
+        if(piece == pawns){
+            uint64_t targets = isCapture ? m_lookup->pawnAttacks(startingSquare, m_sideToMove)
+                : m_lookup->pawnPushes(startingSquare, m_sideToMove);
+            valid = (targets & toMask & ~lastRank) != 0;
+        }
+        else valid = (getAttackSet(piece, occupied, startingSquare) & toMask) != 0;
+        break;
+    case doublePush:
+        if(piece == pawns){
+            uint64_t singlePush = m_lookup->pawnPushes(startingSquare, m_sideToMove) & ~occupied;
+            valid = singlePush && (m_lookup->pawnPushes(btw::bitScanForward(singlePush), m_sideToMove) & toMask)
+                && ((m_sideToMove == white && startingSquare / 8 == 1) || (m_sideToMove == black && startingSquare / 8 == 6));
+        }
+        break;
+    case kingCastle:
+    case queenCastle:
+        if(piece == kings){
+            MoveList castles;
+            generateCastles(castles);
+            valid = std::find(castles.begin(), castles.end(), move) != castles.end();
+        }
+        break;
+    case enPassant:
+        if(piece == pawns && state().posInfo.isEpPossible()){
+            int epSquare = state().posInfo.getEpSquare();
+            valid = endSquare == (m_sideToMove == white ? epSquare + 8 : epSquare - 8)
+                && (m_lookup->pawnAttacks(startingSquare, m_sideToMove) & toMask);
+        }
+        break;
+    case knightPromo:
+    case bishopPromo:
+    case rookPromo:
+    case queenPromo:
+        valid = piece == pawns && (m_lookup->pawnPushes(startingSquare, m_sideToMove) & toMask & lastRank);
+        break;
+    case knightPromoCapture:
+    case bishopPromoCapture:
+    case rookPromoCapture:
+    case queenPromoCapture:
+        valid = piece == pawns && (m_lookup->pawnAttacks(startingSquare, m_sideToMove) & toMask & lastRank);
+        break;
+    }
 
-    return float(npm - egMin) / float(mgMax-egMin);
+    if(valid && isLegalMove(move)) {
+        t_out = move;
+        return true;
+    }
+    return false;
 }
 
 void ChessBoard::makeMove(ChessMove t_move)
 {
-    PosInfo newPosInfo(m_posHistory.back());
+    PosInfo newPosInfo(state().posInfo);
     newPosInfo.incrementHalfmoveClock();
     newPosInfo.setEpState(false);
 
@@ -434,7 +547,7 @@ void ChessBoard::makeMove(ChessMove t_move)
 
         m_bitBoard[t_move.getCaptured()] ^= captureMask;
         m_bitBoard[1 - m_sideToMove] ^= captureMask; 
-        if(t_move.getCaptured() != pawns)m_nonPawnPieces -= mgValue[t_move.getCaptured() - 2];       
+        if(t_move.getCaptured() != pawns)m_nonPawnPieces[1 - m_sideToMove] -= mgValue[t_move.getCaptured() - 2];       
         break;
     case queenCastle: 
         if(m_sideToMove == white){
@@ -484,12 +597,12 @@ void ChessBoard::makeMove(ChessMove t_move)
 
         m_bitBoard[t_move.getCaptured()] ^= captureMask;
         m_bitBoard[pawns] ^= moveMask;
-        if(t_move.getCaptured() != pawns) m_nonPawnPieces -= mgValue[t_move.getCaptured() - 2];
+        if(t_move.getCaptured() != pawns) m_nonPawnPieces[1 - m_sideToMove] -= mgValue[t_move.getCaptured() - 2];
 
         m_bitBoard[t_move.getPromoPiece()] ^= promoMask;
         m_bitBoard[1 - m_sideToMove] ^= captureMask;
         m_bitBoard[m_sideToMove] ^= moveMask | promoMask;
-        m_nonPawnPieces += mgValue[t_move.getPromoPiece() - 2];
+        m_nonPawnPieces[m_sideToMove] += mgValue[t_move.getPromoPiece() - 2];
         break;
     case knightPromo:
     case bishopPromo:
@@ -502,7 +615,7 @@ void ChessBoard::makeMove(ChessMove t_move)
         m_bitBoard[pawns] ^= moveMask;
         m_bitBoard[t_move.getPromoPiece()] ^= promoMask;
         m_bitBoard[m_sideToMove] ^= moveMask | promoMask;
-        m_nonPawnPieces += mgValue[t_move.getPromoPiece() - 2];
+        m_nonPawnPieces[m_sideToMove] += mgValue[t_move.getPromoPiece() - 2];
         break;
     case doublePush:
         newPosInfo.resetHalfmoveClock();
@@ -516,13 +629,62 @@ void ChessBoard::makeMove(ChessMove t_move)
         break;
     }
 
-    m_posHistory.emplace_back(newPosInfo);
+    const StateInfo &previous = state();
+    StateInfo &next = m_states[(m_gamePly + 1) & c_stateMask];
+    next.posInfo = newPosInfo;
+    next.psqt = previous.psqt + psqtDelta(t_move, m_sideToMove);
+    next.key = previous.key ^ moveKey(t_move, m_sideToMove) ^ stateKey(previous.posInfo) ^ stateKey(newPosInfo) ^ zobrist::keys.side;
+    next.captured = t_move.isCapture() ? t_move.getCaptured() : 0;
+    next.pliesFromNull = previous.pliesFromNull + 1;
+    if(m_network)
+        m_network->update(m_accumulators[m_gamePly], m_accumulators[m_gamePly + 1], featureDelta(t_move, m_sideToMove));
+    m_gamePly ++;
     toggleSideToMove();
+    updateCheckInfo();
+}
+
+bool ChessBoard::isDraw(int t_ply)
+{
+    if (isInsufficientMaterial() || isRepetition(t_ply)) return true;
+    if (state().posInfo.getHalfmoveClock() < 100) return false;
+
+    // checkmate on the move that completes the fifty takes precedence over the draw
+    if (!isCheck()) return true;
+    MoveList moves;
+    generateCaptures(moves);
+    generateQuiets(moves);
+    return moves.size() > 0;
+}
+
+void ChessBoard::makeNullMove()
+{
+    PosInfo newPosInfo(state().posInfo);
+    newPosInfo.incrementHalfmoveClock();
+    newPosInfo.setEpState(false);
+
+    const StateInfo &previous = state();
+    StateInfo &next = m_states[(m_gamePly + 1) & c_stateMask];
+    next.posInfo = newPosInfo;
+    next.psqt = previous.psqt;
+    next.key = previous.key ^ stateKey(previous.posInfo) ^ stateKey(newPosInfo) ^ zobrist::keys.side;
+    next.captured = 0;
+    next.pliesFromNull = 0;
+    if(m_network) m_accumulators[m_gamePly + 1] = m_accumulators[m_gamePly];
+    m_gamePly ++;
+    toggleSideToMove();
+    updateCheckInfo();
+}
+
+void ChessBoard::undoNullMove()
+{
+    toggleSideToMove();
+    m_gamePly --;
 }
 
 void ChessBoard::undoMove(ChessMove t_move)
 {
     toggleSideToMove();
+    int captured = state().captured;
 
     if(t_move.getPiece() == kings) m_kingSquare[m_sideToMove] = t_move.getStartingSquare();
 
@@ -543,9 +705,9 @@ void ChessBoard::undoMove(ChessMove t_move)
         m_bitBoard[t_move.getPiece()] ^= moveMask;
         m_bitBoard[m_sideToMove] ^= moveMask;
 
-        m_bitBoard[t_move.getCaptured()] ^= captureMask;
+        m_bitBoard[captured] ^= captureMask;
         m_bitBoard[1 - m_sideToMove] ^= captureMask; 
-        if(t_move.getCaptured() != pawns)m_nonPawnPieces += mgValue[t_move.getCaptured() - 2];              
+        if(captured != pawns)m_nonPawnPieces[1 - m_sideToMove] += mgValue[captured - 2];              
         break;
     case queenCastle: 
         if(m_sideToMove == white){
@@ -591,14 +753,14 @@ void ChessBoard::undoMove(ChessMove t_move)
         moveMask = (uint64_t) 1 << t_move.getStartingSquare();
         promoMask= (uint64_t) 1 << t_move.getEndSquare();
 
-        m_bitBoard[t_move.getCaptured()] ^= captureMask;
+        m_bitBoard[captured] ^= captureMask;
         m_bitBoard[pawns] ^= moveMask;
-        if(t_move.getCaptured() != pawns) m_nonPawnPieces += mgValue[t_move.getCaptured() - 2];
+        if(captured != pawns) m_nonPawnPieces[1 - m_sideToMove] += mgValue[captured - 2];
 
         m_bitBoard[t_move.getPromoPiece()] ^= promoMask;
         m_bitBoard[1 - m_sideToMove] ^= captureMask;
         m_bitBoard[m_sideToMove] ^= moveMask | promoMask;
-        m_nonPawnPieces -= mgValue[t_move.getPromoPiece() - 2];
+        m_nonPawnPieces[m_sideToMove] -= mgValue[t_move.getPromoPiece() - 2];
         break;
     case knightPromo:
     case bishopPromo:
@@ -610,7 +772,7 @@ void ChessBoard::undoMove(ChessMove t_move)
         m_bitBoard[pawns] ^= moveMask;
         m_bitBoard[t_move.getPromoPiece()] ^= promoMask;
         m_bitBoard[m_sideToMove] ^= moveMask | promoMask;
-        m_nonPawnPieces -= mgValue[t_move.getPromoPiece() - 2];
+        m_nonPawnPieces[m_sideToMove] -= mgValue[t_move.getPromoPiece() - 2];
         break;
     case doublePush:
         moveMask  = (uint64_t) 1 << t_move.getStartingSquare();
@@ -621,70 +783,240 @@ void ChessBoard::undoMove(ChessMove t_move)
         break;
     }
 
-    m_posHistory.pop_back();
+    // everything else about the previous position is still on the state stack
+    m_gamePly --;
+}
+
+// Derives from the bitboards everything that makeMove/undoMove then keep up to date
+void ChessBoard::initState()
+{
+    m_kingSquare[white] = btw::bitScanForward(m_bitBoard[white] & m_bitBoard[kings]);
+    m_kingSquare[black] = btw::bitScanForward(m_bitBoard[black] & m_bitBoard[kings]);
+    for (int side = white; side <= black; side ++){
+        m_nonPawnPieces[side] = 0;
+        for (int pieces = knights; pieces <= kings; pieces ++)
+            m_nonPawnPieces[side] += btw::popCount(m_bitBoard[pieces] & m_bitBoard[side]) * mgValue[pieces - 2];
+    }
+    state().key = computeKey();
+    state().psqt = computePsqt();
+    state().captured = 0;
+    state().pliesFromNull = 0;
+    if (m_network) m_network->refresh(m_bitBoard, m_accumulators[m_gamePly]);
+    updateCheckInfo();
+}
+
+void ChessBoard::toggleSideToMove()
+{
+    m_sideToMove = 1 - m_sideToMove;
 }
 
-bool ChessBoard::isCheck()
+// Checkers and pins are found once per position, the generators then only mask their targets with them
+void ChessBoard::updateCheckInfo()
 {
-    return isCheck(1 - m_sideToMove);
+    int kingSquare = m_kingSquare[m_sideToMove];
+    uint64_t occupied = m_bitBoard[white] | m_bitBoard[black];
+    uint64_t enemyPcs = m_bitBoard[1 - m_sideToMove];
+    uint64_t straight = (m_bitBoard[rooks] | m_bitBoard[queens]) & enemyPcs;
+    uint64_t diagonal = (m_bitBoard[bishops] | m_bitBoard[queens]) & enemyPcs;
+
+    state().checkers = (m_lookup->pawnAttacks(kingSquare, m_sideToMove) & m_bitBoard[pawns] & enemyPcs)
+        | (m_lookup->knightAttacks(kingSquare) & m_bitBoard[knights] & enemyPcs)
+        | (m_lookup->rookAttacks(occupied, kingSquare) & straight)
+        | (m_lookup->bishopAttacks(occupied, kingSquare) & diagonal);
+
+    // a slider that would see the king through exactly one of our pieces pins it
+    uint64_t pinned = 0;
+    uint64_t snipers = (m_lookup->rookAttacks(0, kingSquare) & straight) | (m_lookup->bishopAttacks(0, kingSquare) & diagonal);
+    if (snipers) do {
+        uint64_t blockers = m_lookup->between(kingSquare, btw::bitScanForward(snipers)) & occupied;
+        if (blockers && !(blockers & (blockers - 1))) pinned |= blockers & m_bitBoard[m_sideToMove];
+    } while (snipers &= (snipers - 1));
+    state().pinned = pinned;
 }
 
-bool ChessBoard::checkInfo(int &t_checkingPiece)
+// With a single checker a move must capture it or step in between, otherwise any square will do
+uint64_t ChessBoard::evasionTargets() const
 {
-    uint64_t pawnsSet = m_bitBoard[pawns] & m_bitBoard[1 - m_sideToMove];
-    if ((m_lookup.pawnAttacks(m_kingSquare[m_sideToMove], m_sideToMove) & pawnsSet) != 0) {
-        t_checkingPiece = pawns;
-        return true;
-    }
+    uint64_t checkers = state().checkers;
+    if (!checkers) return ~(uint64_t) 0;
+    return checkers | m_lookup->between(m_kingSquare[m_sideToMove], btw::bitScanForward(checkers));
+}
+
+// The king is removed from the board first, otherwise it would hide the squares behind it from a checking slider
+uint64_t ChessBoard::safeKingSquares()
+{
+    int kingSquare = m_kingSquare[m_sideToMove];
+    uint64_t occupied = (m_bitBoard[white] | m_bitBoard[black]) ^ ((uint64_t) 1 << kingSquare);
+    uint64_t candidates = m_lookup->kingAttacks(kingSquare) & ~m_bitBoard[m_sideToMove];
+    uint64_t safe = 0;
+
+    if (candidates) do {
+        int square = btw::bitScanForward(candidates);
+        if (!isSquareAttacked(occupied, square, 1 - m_sideToMove)) safe |= (uint64_t) 1 << square;
+    } while (candidates &= (candidates - 1));
+    return safe;
+}
 
+// En passant removes two pieces from the same rank, which no pin mask describes, so the
+// resulting occupancy is checked for slider attacks directly
+bool ChessBoard::isLegalEp(int t_startingSquare, int t_epSquare) const
+{
+    int kingSquare = m_kingSquare[m_sideToMove];
+    int endSquare = m_sideToMove == white ? t_epSquare + 8 : t_epSquare - 8;
+    uint64_t epMask = (uint64_t) 1 << t_epSquare;
+    uint64_t occupied = ((m_bitBoard[white] | m_bitBoard[black]) ^ ((uint64_t) 1 << t_startingSquare) ^ epMask) | ((uint64_t) 1 << endSquare);
+    uint64_t enemyPcs = m_bitBoard[1 - m_sideToMove];
 
-    uint64_t occupied = m_bitBoard[white] | m_bitBoard[black];
+    if (m_lookup->rookAttacks(occupied, kingSquare) & (m_bitBoard[rooks] | m_bitBoard[queens]) & enemyPcs) return false;
+    if (m_lookup->bishopAttacks(occupied, kingSquare) & (m_bitBoard[bishops] | m_bitBoard[queens]) & enemyPcs) return false;
+    // a knight, or a pawn other than the captured one, would still be giving check
+    return (state().checkers & ~epMask & (m_bitBoard[knights] | m_bitBoard[pawns])) == 0;
+}
 
-    for(int pieces = knights; pieces < kings; pieces ++){
-        uint64_t piecesSet = m_bitBoard[pieces] & m_bitBoard[1 - m_sideToMove];
-        if((getAttackSet(pieces, occupied, m_kingSquare[m_sideToMove]) & piecesSet) != 0){
-            t_checkingPiece = pieces;
-            return true;
+// Legality of a pseudo-legal move, for the moves that do not come from the generators
+bool ChessBoard::isLegalMove(ChessMove t_move)
+{
+    int kingSquare = m_kingSquare[m_sideToMove];
+    int startingSquare = t_move.getStartingSquare();
+    uint64_t toMask = (uint64_t) 1 << t_move.getEndSquare();
+    uint64_t checkers = state().checkers;
+
+    if (t_move.isCastle()) return true;     // generateCastles already checked every square
+    if (t_move.getPiece() == kings) return (safeKingSquares() & toMask) != 0;
+    if (t_move.isEnPassant()) return isLegalEp(startingSquare, state().posInfo.getEpSquare());
+    if (checkers & (checkers - 1)) return false;
+    if (!(evasionTargets() & toMask)) return false;
+    return !(state().pinned & ((uint64_t) 1 << startingSquare)) || (m_lookup->line(kingSquare, startingSquare) & toMask);
+}
+
+uint64_t ChessBoard::computeKey() const
+{
+    uint64_t key = stateKey(state().posInfo);
+    if (m_sideToMove == black) key ^= zobrist::keys.side;
+
+    for (int side = white; side <= black; side ++){
+        for (int piece = pawns; piece <= kings; piece ++){
+            uint64_t pieceSet = m_bitBoard[piece] & m_bitBoard[side];
+            if (pieceSet) do {
+                key ^= zobrist::keys.piece[side][piece][btw::bitScanForward(pieceSet)];
+            } while (pieceSet &= (pieceSet - 1));
         }
     }
 
-    return false;
+    return key;
 }
 
+int ChessBoard::computePsqt() const
+{
+    int score = 0;
+    for (int side = white; side <= black; side ++){
+        for (int piece = pawns; piece <= kings; piece ++){
+            uint64_t pieceSet = m_bitBoard[piece] & m_bitBoard[side];
+            if (pieceSet) do {
+                score += psqt.score[side][piece][btw::bitScanForward(pieceSet)];
+            } while (pieceSet &= (pieceSet - 1));
+        }
+    }
+
+    return score;
+}
 
-void ChessBoard::initBoard(){
-    // m_bitBoard[white]   = (uint64_t) 0x000000000000ffff;
-    // m_bitBoard[black]   = (uint64_t) 0xffff000000000000;
-    // m_bitBoard[pawns]   = (uint64_t) 0x00ff00000000ff00;
-    // m_bitBoard[knights] = (uint64_t) 0x4200000000000042;
-    // m_bitBoard[bishops] = (uint64_t) 0x2400000000000024;
-    // m_bitBoard[rooks]   = (uint64_t) 0x8100000000000081;
-    // m_bitBoard[queens]  = (uint64_t) 0x0800000000000008;
-    // m_bitBoard[kings]   = (uint64_t) 0x1000000000000010;
+// Piece-square score difference between the positions before and after t_move,
+// added by makeMove and subtracted by undoMove
+int ChessBoard::psqtDelta(ChessMove t_move, int t_side) const
+{
+    const auto &score = psqt.score;
+    int from = t_move.getStartingSquare();
+    int to = t_move.getEndSquare();
+    int delta = - score[t_side][t_move.getPiece()][from];
 
-    m_bitBoard[white]   = (uint64_t) 0x000000181024ff91;
-    m_bitBoard[black]   = (uint64_t) 0x917d730002800000;
-    m_bitBoard[pawns]   = (uint64_t) 0x002d50081280e700;
-    m_bitBoard[knights] = (uint64_t) 0x0000221000040000;
-    m_bitBoard[bishops] = (uint64_t) 0x0040010000001800;
-    m_bitBoard[rooks]   = (uint64_t) 0x8100000000000081;
-    m_bitBoard[queens]  = (uint64_t) 0x0010000000200000;
-    m_bitBoard[kings]   = (uint64_t) 0x1000000000000010;
+    switch (t_move.getFlags())
+    {
+    case kingCastle:
+        delta += score[t_side][kings][to] + score[t_side][rooks][to - 1] - score[t_side][rooks][to + 1];
+        break;
+    case queenCastle:
+        delta += score[t_side][kings][to] + score[t_side][rooks][to + 1] - score[t_side][rooks][to - 2];
+        break;
+    case enPassant:
+        delta += score[t_side][pawns][to] - score[1 - t_side][pawns][t_side == white ? to - 8 : to + 8];
+        break;
+    default:
+        delta += score[t_side][t_move.isPromo() ? t_move.getPromoPiece() : t_move.getPiece()][to];
+        if (t_move.isCapture()) delta -= score[1 - t_side][t_move.getCaptured()][to];
+        break;
+    }
 
-    // m_bitBoard[white]   = (uint64_t) 0x0020000000000010;
-    // m_bitBoard[black]   = (uint64_t) 0x8000000000000000;
-    // m_bitBoard[pawns]   = (uint64_t) 0x0000000000000000;
-    // m_bitBoard[knights] = (uint64_t) 0x0000000000000000;
-    // m_bitBoard[bishops] = (uint64_t) 0x0000000000000000;
-    // m_bitBoard[rooks]   = (uint64_t) 0x0020000000000000;
-    // m_bitBoard[queens]  = (uint64_t) 0x0000000000000000;
-    // m_bitBoard[kings]   = (uint64_t) 0x8000000000000010;
+    return delta;
 }
 
+// Network inputs switched on and off by t_move, the same cases as psqtDelta
+FeatureDelta ChessBoard::featureDelta(ChessMove t_move, int t_side) const
+{
+    FeatureDelta delta;
+    int from = t_move.getStartingSquare();
+    int to = t_move.getEndSquare();
+    delta.remove(t_side, t_move.getPiece(), from);
 
-void ChessBoard::toggleSideToMove()
+    switch (t_move.getFlags())
+    {
+    case kingCastle:
+        delta.add(t_side, kings, to);
+        delta.add(t_side, rooks, to - 1);
+        delta.remove(t_side, rooks, to + 1);
+        break;
+    case queenCastle:
+        delta.add(t_side, kings, to);
+        delta.add(t_side, rooks, to + 1);
+        delta.remove(t_side, rooks, to - 2);
+        break;
+    case enPassant:
+        delta.add(t_side, pawns, to);
+        delta.remove(1 - t_side, pawns, t_side == white ? to - 8 : to + 8);
+        break;
+    default:
+        delta.add(t_side, t_move.isPromo() ? t_move.getPromoPiece() : t_move.getPiece(), to);
+        if (t_move.isCapture()) delta.remove(1 - t_side, t_move.getCaptured(), to);
+        break;
+    }
+
+    return delta;
+}
+
+// Piece-square part of the key difference between the positions before and after t_move.
+// Being a xor it is the same for makeMove and undoMove
+uint64_t ChessBoard::moveKey(ChessMove t_move, int t_side) const
 {
-    m_sideToMove = 1 - m_sideToMove;
+    const auto &piece = zobrist::keys.piece;
+    int from = t_move.getStartingSquare();
+    int to = t_move.getEndSquare();
+    uint64_t key = piece[t_side][t_move.getPiece()][from];
+
+    switch (t_move.getFlags())
+    {
+    case kingCastle:
+        key ^= piece[t_side][kings][to] ^ piece[t_side][rooks][to + 1] ^ piece[t_side][rooks][to - 1];
+        break;
+    case queenCastle:
+        key ^= piece[t_side][kings][to] ^ piece[t_side][rooks][to - 2] ^ piece[t_side][rooks][to + 1];
+        break;
+    case enPassant:
+        key ^= piece[t_side][pawns][to] ^ piece[1 - t_side][pawns][t_side == white ? to - 8 : to + 8];
+        break;
+    default:
+        key ^= piece[t_side][t_move.isPromo() ? t_move.getPromoPiece() : t_move.getPiece()][to];
+        if (t_move.isCapture()) key ^= piece[1 - t_side][t_move.getCaptured()][to];
+        break;
+    }
+
+    return key;
+}
+
+uint64_t ChessBoard::stateKey(const PosInfo &t_info) const
+{
+    uint64_t key = zobrist::keys.castling[t_info.getCastlingRights()];
+    if (t_info.isEpPossible()) key ^= zobrist::keys.epFile[t_info.getEpSquare() % 8];
+    return key;
 }
 
 int ChessBoard::capturedPiece(int t_square)
@@ -701,6 +1033,103 @@ int ChessBoard::capturedPiece(int t_square)
     return taken;
 }
 
+// Only positions after the last capture, pawn move or null move can repeat, and only every second ply
+// has the same side to move, so the scan is short and starts four plies back
+bool ChessBoard::isRepetition(int t_ply) const
+{
+    int distance = std::min({state().posInfo.getHalfmoveClock(), state().pliesFromNull, m_gamePly - m_firstPly, c_stateCapacity - 1});
+    uint64_t key = state().key;
+    bool repeated = false;
+
+    for (int i = 4; i <= distance; i += 2){
+        if (m_states[(m_gamePly - i) & c_stateMask].key != key) continue;
+        if (i < t_ply || repeated) return true;
+        repeated = true;
+    }
+    return false;
+}
+
+// Minor pieces only: no mate is possible with a lone minor or with bishops all on squares of one colour,
+// and none can be forced with one minor each or two knights against a bare king. The last two are scored as
+// draws although a helpmate exists, as the search would otherwise chase positions nobody can win
+bool ChessBoard::isInsufficientMaterial() const
+{
+    if (m_bitBoard[pawns] | m_bitBoard[rooks] | m_bitBoard[queens]) return false;
+
+    uint64_t minors = m_bitBoard[knights] | m_bitBoard[bishops];
+    if (btw::popCount(minors) <= 1) return true;
+
+    const uint64_t darkSquares = 0xaa55aa55aa55aa55;
+    if (!m_bitBoard[knights] && (!(m_bitBoard[bishops] & darkSquares) || !(m_bitBoard[bishops] & ~darkSquares))) return true;
+
+    int whiteMinors = btw::popCount(minors & m_bitBoard[white]), blackMinors = btw::popCount(minors & m_bitBoard[black]);
+    if (whiteMinors == 1 && blackMinors == 1) return true;
+    return minors == m_bitBoard[knights] && btw::popCount(minors) == 2 && (whiteMinors == 0 || blackMinors == 0);
+}
+
+// Pieces of both sides attacking the square, seen through the given occupancy
+uint64_t ChessBoard::attackersTo(uint64_t t_occupied, int t_square) const
+{
+    return (m_lookup->pawnAttacks(t_square, black) & m_bitBoard[pawns] & m_bitBoard[white])
+        | (m_lookup->pawnAttacks(t_square, white) & m_bitBoard[pawns] & m_bitBoard[black])
+        | (m_lookup->knightAttacks(t_square) & m_bitBoard[knights])
+        | (m_lookup->bishopAttacks(t_occupied, t_square) & (m_bitBoard[bishops] | m_bitBoard[queens]))
+        | (m_lookup->rookAttacks(t_occupied, t_square) & (m_bitBoard[rooks] | m_bitBoard[queens]))
+        | (m_lookup->kingAttacks(t_square) & m_bitBoard[kings]);
+}
+
+// Static exchange evaluation: true when the exchange started by the move on its end square wins at least
+// t_threshold. Both sides recapture with their least valuable attacker and may stop whenever going on
+// would lose material; removing an attacker from the occupancy uncovers the sliders lined up behind it
+bool ChessBoard::see(ChessMove t_move, int t_threshold) const
+{
+    if (t_move.isCastle()) return 0 >= t_threshold;
+
+    int startingSquare = t_move.getStartingSquare();
+    int endSquare = t_move.getEndSquare();
+    int moved = t_move.isPromo() ? t_move.getPromoPiece() : t_move.getPiece();
+
+    int swap = (t_move.isCapture() ? mgValue[t_move.getCaptured() - 2] : 0) - t_threshold;
+    if (t_move.isPromo()) swap += mgValue[moved - 2] - mgValue[pawns - 2];
+    if (swap < 0) return false;
+
+    // the opponent now gets the moved piece, if even that keeps us above the threshold we are done
+    swap = mgValue[moved - 2] - swap;
+    if (swap <= 0) return true;
+
+    uint64_t occupied = (m_bitBoard[white] | m_bitBoard[black]) ^ ((uint64_t) 1 << startingSquare) ^ ((uint64_t) 1 << endSquare);
+    if (t_move.isEnPassant()) occupied ^= (uint64_t) 1 << state().posInfo.getEpSquare();
+    uint64_t diagonal = m_bitBoard[bishops] | m_bitBoard[queens];
+    uint64_t straight = m_bitBoard[rooks] | m_bitBoard[queens];
+    uint64_t attackers = attackersTo(occupied, endSquare);
+    int side = m_sideToMove;
+    int res = 1;
+
+    while (true){
+        side = 1 - side;
+        attackers &= occupied;
+        uint64_t sideAttackers = attackers & m_bitBoard[side];
+        if (!sideAttackers) break;
+        res ^= 1;
+
+        int piece = pawns;
+        while (!(sideAttackers & m_bitBoard[piece])) piece ++;
+
+        // the king may only take last, when nothing defends the square any more
+        if (piece == kings) return (attackers & m_bitBoard[1 - side]) ? !res : res;
+        if ((swap = mgValue[piece - 2] - swap) < res) break;
+
+        uint64_t attacker = sideAttackers & m_bitBoard[piece];
+        occupied ^= attacker & (~attacker + 1);
+        if (piece == pawns || piece == bishops || piece == queens)
+            attackers |= m_lookup->bishopAttacks(occupied, endSquare) & diagonal;
+        if (piece == rooks || piece == queens)
+            attackers |= m_lookup->rookAttacks(occupied, endSquare) & straight;
+    }
+
+    return res;
+}
+
 uint64_t ChessBoard::getAttackSet(int t_pieceType, uint64_t t_occupied, int t_square)
 {
     using AttackFunction = uint64_t (LookupTables::*)(uint64_t, int) const;
@@ -713,13 +1142,13 @@ uint64_t ChessBoard::getAttackSet(int t_pieceType, uint64_t t_occupied, int t_sq
         &LookupTables::kingAttacks // kings
     };
     
-    return (m_lookup.*attackFunctions[t_pieceType - 3])(t_occupied, t_square);
+    return (m_lookup->*attackFunctions[t_pieceType - 3])(t_occupied, t_square);
 }
 
 bool ChessBoard::isSquareAttacked(uint64_t t_occupied, int t_square, int t_attackingSide)
 {
     uint64_t pawnsSet = m_bitBoard[pawns] & m_bitBoard[t_attackingSide];
-    if ((m_lookup.pawnAttacks(t_square, 1-t_attackingSide) & pawnsSet) != 0) return true;
+    if ((m_lookup->pawnAttacks(t_square, 1-t_attackingSide) & pawnsSet) != 0) return true;
 
 
     for (int pieces = knights; pieces <= kings; pieces ++){
@@ -730,85 +1159,58 @@ bool ChessBoard::isSquareAttacked(uint64_t t_occupied, int t_square, int t_attac
     return false;
 }
 
-bool ChessBoard::isCheck(int t_attackingSide)
+bool ChessBoard::isSquareAttacked(int t_square, int t_attackingSide)
 {
-    uint64_t occupied = m_bitBoard[white] | m_bitBoard[black];
-
-    return isSquareAttacked(occupied, m_kingSquare[1 - t_attackingSide], t_attackingSide);
+    return isSquareAttacked(m_bitBoard[white] | m_bitBoard[black], t_square, t_attackingSide);
 }
 
-std::ostream &operator<<(std::ostream &os, const ChessBoard &cb)
-{   
+std::string ChessBoard::toFEN() const
+{
+    const std::string pieceChars = "PNBRQKpnbrqk";
+    std::string fen;
+
     for (int rank = 7; rank >= 0; rank --){
         int emptySquares = 0;
         for (int file = 0; file < 8; file ++){
             uint64_t squareMask = (uint64_t) 1 << (rank * 8 + file);
+            int piece = pawns;
+            while (piece <= kings && !(m_bitBoard[piece] & squareMask)) piece ++;
 
-            if (squareMask & cb.m_bitBoard[pawns]){
-                if(emptySquares) os << emptySquares;
-                emptySquares = 0;
-                if (squareMask & cb.m_bitBoard[white]) os << "P";
-                else if (squareMask & cb.m_bitBoard[black]) os << "p";
-            }
-            else if(squareMask & cb.m_bitBoard[knights]){
-                if(emptySquares) os << emptySquares;
+            if (piece > kings) emptySquares ++;
+            else {
+                if (emptySquares) fen += char('0' + emptySquares);
                 emptySquares = 0;
-                if (squareMask & cb.m_bitBoard[white]) os << "N";
-                else if (squareMask & cb.m_bitBoard[black]) os << "n";
+                fen += pieceChars[piece - pawns + (m_bitBoard[black] & squareMask ? 6 : 0)];
             }
-            else if(squareMask & cb.m_bitBoard[bishops]){
-                if(emptySquares) os << emptySquares;
-                emptySquares = 0;
-                if (squareMask & cb.m_bitBoard[white]) os << "B";
-                else if (squareMask & cb.m_bitBoard[black]) os << "b";
-            }
-            else if(squareMask & cb.m_bitBoard[rooks]){
-                if(emptySquares) os << emptySquares;
-                emptySquares = 0;
-                if (squareMask & cb.m_bitBoard[white]) os << "R";
-                else if (squareMask & cb.m_bitBoard[black]) os << "r";
-            }
-            else if(squareMask & cb.m_bitBoard[queens]){
-                if(emptySquares) os << emptySquares;
-                emptySquares = 0;
-                if (squareMask & cb.m_bitBoard[white]) os << "Q";
-                else if (squareMask & cb.m_bitBoard[black]) os << "q";
-            }
-            else if(squareMask & cb.m_bitBoard[kings]){
-                if(emptySquares) os << emptySquares;
-                emptySquares = 0;
-                if (squareMask & cb.m_bitBoard[white]) os << "K";
-                else if (squareMask & cb.m_bitBoard[black]) os << "k";
-            }
-            else emptySquares ++;
         }
-        if (emptySquares) os << emptySquares;
-        if (rank != 0) os << "/";
+        if (emptySquares) fen += char('0' + emptySquares);
+        if (rank != 0) fen += '/';
     }
 
-    if (cb.m_sideToMove == white) os << " w ";
-    else os << " b ";
-
-    PosInfo info(cb.m_posHistory.back());
-    if(info.getShortCastlingRights(white)) os << "K";
-    if(info.getLongCastlingRights(white)) os << "Q";
-    if(info.getShortCastlingRights(black)) os << "k";
-    if(info.getLongCastlingRights(black)) os << "q";
+    fen += m_sideToMove == white ? " w " : " b ";
+
+    const PosInfo &info = state().posInfo;
+    std::string castling;
+    if (info.getShortCastlingRights(white)) castling += 'K';
+    if (info.getLongCastlingRights(white)) castling += 'Q';
+    if (info.getShortCastlingRights(black)) castling += 'k';
+    if (info.getLongCastlingRights(black)) castling += 'q';
+    fen += castling.empty() ? "-" : castling;
+
+    if (info.isEpPossible()){
+        int target = info.getEpSquare() + (m_sideToMove == white ? 8 : -8);
+        fen += ' ';
+        fen += char('a' + target % 8);
+        fen += char('1' + target / 8);
+    }
+    else fen += " -";
 
-    if(info.isEpPossible()) os << " " << info.getEpSquare() << " ";
-    else os << " - ";
+    fen += ' ' + std::to_string(info.getHalfmoveClock()) + ' ' + std::to_string(1 + m_gamePly / 2);
 
-    return os;
+    return fen;
 }
 
-std::size_t HashFunction::operator()(const ChessBoard &obj) const
+std::ostream &operator<<(std::ostream &os, const ChessBoard &cb)
 {
-    std::size_t seed = 10009507;
-    seed ^= std::hash<int>()(obj.m_sideToMove) + 0x9e3779b9 + (seed << 6) + (seed >> 2);
-    for (const auto& bitboard : obj.m_bitBoard) {
-        seed ^= std::hash<uint64_t>()(bitboard) + 0x9e3779b9 + (seed << 6) + (seed >> 2);
-    }
-    seed ^= std::hash<int>()(obj.m_posHistory.back().getInfo()) + 0x9e3779b9 + (seed << 6) + (seed >> 2);
-
-    return seed;
+    return os << cb.toFEN();
 }
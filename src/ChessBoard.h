@@ -1,69 +1,116 @@
 #pragma once
 
 #include <cstdint>
-#include <vector>
+#include <string>
 
 #include "ChessMove.h"
+#include "MoveList.h"
 #include "LookupTables.h"
+#include "Network.h"
 #include "PosInfo.h"
 
 class ChessBoard{
 public:
     ChessBoard();
-    ChessBoard(const ChessBoard &);
+    explicit ChessBoard(const std::string &t_fen);
+    ChessBoard(const ChessBoard &) = default;
     ~ChessBoard() = default;
-    ChessBoard &operator=(const ChessBoard&);
+    ChessBoard &operator=(const ChessBoard&) = default;
     bool operator==(const ChessBoard &t_other) const;
 
-    friend struct HashFunction;
     friend std::ostream& operator<<(std::ostream& os,const ChessBoard& cb);
 public:
-    bool isIllegal();
-    bool isLegal();
-
-    std::vector<ChessMove> getCaptures();
-    std::vector<ChessMove> getQuiets();
-    std::vector<uint64_t> getBitBoards() const;
+    // Both generators only produce legal moves; queen promotions come with the captures, under-promotions
+    // with the quiets
+    void generateCaptures(MoveList &t_moveList);
+    void generateQuiets(MoveList &t_moveList);
     inline int getSideToMove() const {return m_sideToMove;}
-    float getGamePhase();
+    inline uint64_t getKey() const {return state().key;}
+    inline int getPsqt() const {return state().psqt;}
+    inline int getNonPawnMaterial(int t_side) const {return m_nonPawnPieces[t_side];}
+    // the network active when the board was set up, or none, and its accumulator for the current position
+    inline const Network *getNetwork() const {return m_network;}
+    inline const Accumulator &getAccumulator() const {return m_accumulators[m_gamePly];}
+    std::string toFEN() const;
+    int getGamePhase() const;
+    bool decodeMove(uint16_t t_move, ChessMove &t_out);
     void makeMove(ChessMove t_move);
     void undoMove(ChessMove t_move);
+    // passes the turn, only meant for null move pruning so never called while in check
+    void makeNullMove();
+    void undoNullMove();
 
-    bool isCheck();
-    bool checkInfo(int &t_checkingPiece);
+    bool see(ChessMove t_move, int t_threshold) const;
+    inline bool isCheck() const {return state().checkers != 0;}
+    // draw by the fifty move rule, insufficient material or repetition; a position already met after the
+    // root of the search (t_ply plies ago) counts as a draw on its second occurrence, older ones on the third
+    bool isDraw(int t_ply);
+    bool isSquareAttacked(int t_square, int t_attackingSide);
 
 private:
-    void initBoard();
+    // What makeMove cannot recompute from the bitboards alone, one entry per ply so undoMove just steps back
+    struct StateInfo
+    {
+        PosInfo posInfo;
+        int psqt;
+        uint64_t key;
+        int captured;
+        uint64_t checkers;  // enemy pieces giving check to the side to move
+        uint64_t pinned;    // pieces of the side to move that shield their king from a slider
+        int pliesFromNull;  // positions before a null move can not repeat through it
+    };
+
+    static constexpr int c_stateCapacity = 256;    // a power of two, older entries are overwritten
+    static constexpr int c_stateMask = c_stateCapacity - 1;
+
+    inline StateInfo& state() {return m_states[m_gamePly & c_stateMask];}
+    inline const StateInfo& state() const {return m_states[m_gamePly & c_stateMask];}
+
+    void initState();
     void toggleSideToMove();
+    void updateCheckInfo();
 
+    uint64_t computeKey() const;
+    uint64_t moveKey(ChessMove t_move, int t_side) const;
+    uint64_t stateKey(const PosInfo &t_info) const;
+    int computePsqt() const;
+    int psqtDelta(ChessMove t_move, int t_side) const;
+    FeatureDelta featureDelta(ChessMove t_move, int t_side) const;
 
-    void generatePieceCaptures(int pieceType, std::vector<ChessMove> &t_moveList);
-    void generatePieceQuiets(int pieceType, std::vector<ChessMove> &t_moveList);
-    void generatePawnsCaptures(std::vector<ChessMove>& t_moveList, uint64_t t_pawnsSet, uint64_t t_enemyPcs);
-    void generatePawnsPushes(std::vector<ChessMove>& t_moveList, uint64_t t_pawnsSet, uint64_t t_emptySet);
-    void generateDoublePushes(std::vector<ChessMove>& t_moveList, uint64_t t_pawnSet, uint64_t t_emptySet);
-    void generateEpCaptures(std::vector<ChessMove>& t_moveList, uint64_t t_pawnsSet, int t_epSquare);
-    void generateCastles(std::vector<ChessMove>& t_moveList);
+
+    void generatePieceMoves(int pieceType, MoveList &t_moveList, uint64_t t_targets, int t_flags);
+    void generatePawnsCaptures(MoveList& t_moveList, uint64_t t_pawnsSet, uint64_t t_enemyPcs);
+    void generatePawnsPushes(MoveList& t_moveList, uint64_t t_pawnsSet, uint64_t t_emptySet);
+    void generateQueenPromotions(MoveList& t_moveList, uint64_t t_pawnsSet, uint64_t t_emptySet);
+    void generateDoublePushes(MoveList& t_moveList, uint64_t t_pawnSet, uint64_t t_emptySet, uint64_t t_targets);
+    void generateEpCaptures(MoveList& t_moveList, uint64_t t_pawnsSet, int t_epSquare);
+    void generateCastles(MoveList& t_moveList);
+
+    uint64_t evasionTargets() const;
+    uint64_t safeKingSquares();
+    bool isLegalEp(int t_startingSquare, int t_epSquare) const;
+    bool isLegalMove(ChessMove t_move);
 
     int capturedPiece(int t_square);
+    uint64_t attackersTo(uint64_t t_occupied, int t_square) const;
     uint64_t getAttackSet(int t_pieceType, uint64_t t_occupied, int t_square);
 
     
     bool isSquareAttacked(uint64_t t_occupied, int t_square, int t_attackingSide);
-    bool isCheck(int t_attackingSide);
+    bool isRepetition(int t_ply) const;
+    bool isInsufficientMaterial() const;
 
 private:
     int m_sideToMove;
-    int m_nonPawnPieces;
+    int m_nonPawnPieces[2];
     int m_kingSquare[2];
     uint64_t m_bitBoard[8];
+    int m_gamePly;
+    int m_firstPly;     // ply of the position the board was set up from, the state stack holds nothing older
 
-    std::vector<PosInfo> m_posHistory;
-
-    LookupTables& m_lookup;
-};
+    StateInfo m_states[c_stateCapacity];
 
-struct HashFunction
-{
-    std::size_t operator()(const ChessBoard &obj) const;
+    const LookupTables *m_lookup;
+    const Network *m_network;
+    AccumulatorStack m_accumulators;    // empty unless m_network is set
 };
\ No newline at end of file
@@ -92,16 +92,27 @@ void ChessMove::setCaptured(uint32_t t_taken)
     m_Move |= (t_taken & 0x0f) << 20;
 }
 
-uint32_t ChessMove::getButterflyIndex()
+uint32_t ChessMove::getButterflyIndex() const
 {
     return m_Move & 0x0fff;
 }
 
-uint16_t ChessMove::asShort()
+uint16_t ChessMove::asShort() const
 {
     return (uint16_t) m_Move;
 }
 
+// Long algebraic notation as used by UCI, e.g. e2e4 or e7e8q
+std::string ChessMove::getNotation() const
+{
+    std::string notation{
+        char('a' + getStartingSquare() % 8), char('1' + getStartingSquare() / 8),
+        char('a' + getEndSquare() % 8), char('1' + getEndSquare() / 8)
+    };
+    if (isPromo()) notation += "nbrq"[getPromoPiece() - knights];
+    return notation;
+}
+
 float ChessMove::getExpectedValue()
 {
     static std::map<int, float> pieceValue{{pawns, 1.0f}, {knights, 2.9f}, {bishops, 3.0f}, {rooks, 5.0f}, {queens, 10.0f}};
@@ -4,6 +4,7 @@
 
 #include <cstdint>
 #include <iostream>
+#include <string>
 
 class ChessMove{
 public:
@@ -36,8 +37,9 @@ public:
     inline bool isEnPassant() const {return getFlags() == enPassant;};
     inline bool isCastle() const {return (getFlags() == kingCastle) || (getFlags() == queenCastle);}
 
-    uint32_t getButterflyIndex();
-    uint16_t asShort();
+    uint32_t getButterflyIndex() const;
+    uint16_t asShort() const;
+    std::string getNotation() const;
 
     float getExpectedValue();
 
@@ -1,32 +1,42 @@
 #include "Evaluation.h"
+#include "ChessBoard.h"
+#include "Network.h"
 #include "utils.h"
 
+namespace
+{
+    constexpr PsqtTable initPsqt(){
+        PsqtTable table{};
+        for(int piece = pawns; piece <= kings; piece ++){
+            for(int square = 0; square < 64; square ++){
+                // the tables are written from white's point of view with the eighth rank first
+                int whiteSquare = 56 - 8 * (square / 8) + square % 8;
+                table.score[white][piece][square] = makeScore(mgValue[piece - 2] + mgSquareTables[piece - 2][whiteSquare],
+                    egValue[piece - 2] + egSquareTables[piece - 2][whiteSquare]);
+                table.score[black][piece][square] = -makeScore(mgValue[piece - 2] + mgSquareTables[piece - 2][square],
+                    egValue[piece - 2] + egSquareTables[piece - 2][square]);
+            }
+        }
+        return table;
+    }
+}
 
+constexpr PsqtTable psqt = initPsqt();
 
-int pieceValue(int piece, int sideToMove, float gamePhase, int square)
+int pieceValue(int piece, int sideToMove, int gamePhase, int square)
 {
     if(sideToMove == white) mirror(square);
-    return (mgValue[piece - 2] + mgSquareTables[piece - 2][square]) * gamePhase 
-        + (egValue[piece - 2] + egSquareTables[piece - 2][square]) * (1 - gamePhase);
+    return ((mgValue[piece - 2] + mgSquareTables[piece - 2][square]) * gamePhase
+        + (egValue[piece - 2] + egSquareTables[piece - 2][square]) * (MAX_PHASE - gamePhase)) / MAX_PHASE;
 }
 
-float evaluate(const std::vector<uint64_t> &bitBoards, float gamePhase)
+Score evaluate(int psqtScore, int gamePhase)
 {
-    int res = 0;
-    for(int piece = pawns; piece <= kings; piece ++){
-        res += countMaterial(piece, white, gamePhase, bitBoards[piece] & bitBoards[white]);
-        res -= countMaterial(piece, black, gamePhase, bitBoards[piece] & bitBoards[black]);
-    }
-    return float(res) / 100;
+    return Score((mgScore(psqtScore) * gamePhase + egScore(psqtScore) * (MAX_PHASE - gamePhase)) / MAX_PHASE);
 }
 
-int countMaterial(int piece, int sideToMove, float gamePhase, uint64_t bitBoard)
+Score evaluate(const ChessBoard &pos)
 {
-    int res = 0;
-
-    if(bitBoard) do{
-        res += pieceValue(piece, sideToMove, gamePhase, btw::bitScanForward(bitBoard));
-    } while (bitBoard &= (bitBoard - 1));
-
-    return res;
+    if(const Network *network = pos.getNetwork()) return network->evaluate(pos.getAccumulator(), pos.getSideToMove());
+    return (1 - 2*pos.getSideToMove()) * evaluate(pos.getPsqt(), pos.getGamePhase());
 }
@@ -1,9 +1,10 @@
 #pragma once
 #include <cstdint>
-#include <vector>
 #include "notation.h"
 
-static int mgKnightTable[64] ={
+class ChessBoard;
+
+static constexpr int mgKnightTable[64] ={
     -167, -89, -34, -49,  61, -97, -15, -107,
      -73, -41,  72,  36,  23,  62,   7,  -17,
      -47,  60,  37,  65,  84, 129,  73,   44,
@@ -14,7 +15,7 @@ static int mgKnightTable[64] ={
     -105, -21, -58, -33, -17, -28, -19,  -23
 };
 
-static int egKnightTable[64] ={
+static constexpr int egKnightTable[64] ={
     -58, -38, -13, -28, -31, -27, -63, -99,
     -25,  -8, -25,  -2,  -9, -25, -24, -52,
     -24, -20,  10,   9,  -1,  -9, -19, -41,
@@ -25,7 +26,7 @@ static int egKnightTable[64] ={
     -29, -51, -23, -15, -22, -18, -50, -64
 };
 
-static int mgBishopTable[64] = {
+static constexpr int mgBishopTable[64] = {
     -29,   4, -82, -37, -25, -42,   7,  -8,
     -26,  16, -18, -13,  30,  59,  18, -47,
     -16,  37,  43,  40,  35,  50,  37,  -2,
@@ -36,7 +37,7 @@ static int mgBishopTable[64] = {
     -33,  -3, -14, -21, -13, -12, -39, -21
 };
 
-static int egBishopTable[64] = {
+static constexpr int egBishopTable[64] = {
     -14, -21, -11,  -8, -7,  -9, -17, -24,
      -8,  -4,   7, -12, -3, -13,  -4, -14,
       2,  -8,   0,  -1, -2,   6,   0,   4,
@@ -47,7 +48,7 @@ static int egBishopTable[64] = {
     -23,  -9, -23,  -5, -9, -16,  -5, -17
 };
 
-static int mgRookTable[64] = {
+static constexpr int mgRookTable[64] = {
      32,  42,  32,  51, 63,  9,  31,  43,
      27,  32,  58,  62, 80, 67,  26,  44,
      -5,  19,  26,  36, 17, 45,  61,  16,
@@ -58,7 +59,7 @@ static int mgRookTable[64] = {
     -19, -13,   1,  17, 16,  7, -37, -26
 };
 
-static int egRookTable[64] = {
+static constexpr int egRookTable[64] = {
     13, 10, 18, 15, 12,  12,   8,   5,
     11, 13, 13, 11, -3,   3,   8,   3,
      7,  7,  7,  5,  4,  -3,  -5,  -3,
@@ -69,7 +70,7 @@ static int egRookTable[64] = {
     -9,  2,  3, -1, -5, -13,   4, -20
 };
 
-static int mgQueenTable[64] = {
+static constexpr int mgQueenTable[64] = {
     -28,   0,  29,  12,  59,  44,  43,  45,
     -24, -39,  -5,   1, -16,  57,  28,  54,
     -13, -17,   7,   8,  29,  56,  47,  57,
@@ -80,7 +81,7 @@ static int mgQueenTable[64] = {
      -1, -18,  -9,  10, -15, -25, -31, -50
 };
 
-static int egQueenTable[64] = {
+static constexpr int egQueenTable[64] = {
      -9,  22,  22,  27,  27,  19,  10,  20,
     -17,  20,  32,  41,  58,  25,  30,   0,
     -20,   6,   9,  49,  47,  35,  19,   9,
@@ -91,7 +92,7 @@ static int egQueenTable[64] = {
     -33, -28, -22, -43,  -5, -32, -20, -41
 };
 
-static int mgKingTable[64] = {
+static constexpr int mgKingTable[64] = {
     -65,  23,  16, -15, -56, -34,   2,  13,
      29,  -1, -20,  -7,  -8,  -4, -38, -29,
      -9,  24,   2, -16, -20,   6,  22, -22,
@@ -102,7 +103,7 @@ static int mgKingTable[64] = {
     -15,  36,  12, -54,   8, -28,  24,  14
 };
 
-static int egKingTable[64] = {
+static constexpr int egKingTable[64] = {
     -74, -35, -18, -18, -11,  15,   4, -17,
     -12,  17,  14,  17,  17,  38,  23,  11,
      10,  17,  23,  15,  20,  45,  44,  13,
@@ -113,7 +114,7 @@ static int egKingTable[64] = {
     -53, -34, -21, -11, -28, -14, -24, -43
 };
 
-static int mgPawnTable[64]={
+static constexpr int mgPawnTable[64]={
       0,   0,   0,   0,   0,   0,  0,   0,
      98, 134,  61,  95,  68, 126, 34, -11,
      -6,   7,  26,  31,  65,  56, 25, -20,
@@ -124,7 +125,7 @@ static int mgPawnTable[64]={
       0,   0,   0,   0,   0,   0,  0,   0
 };
 
-static int egPawnTable[64]={
+static constexpr int egPawnTable[64]={
       0,   0,   0,   0,   0,   0,   0,   0,
     178, 173, 158, 134, 147, 132, 165, 187,
      94, 100,  85,  67,  56,  53,  82,  84,
@@ -135,7 +136,7 @@ static int egPawnTable[64]={
       0,   0,   0,   0,   0,   0,   0,   0
 };
 
-static int *mgSquareTables[6] = {
+static constexpr const int *mgSquareTables[6] = {
     mgPawnTable,
     mgKnightTable,
     mgBishopTable,
@@ -144,7 +145,7 @@ static int *mgSquareTables[6] = {
     mgKingTable
 };
 
-static int *egSquareTables[6] = {
+static constexpr const int *egSquareTables[6] = {
     egPawnTable,
     egKnightTable,
     egBishopTable,
@@ -153,12 +154,29 @@ static int *egSquareTables[6] = {
     egKingTable
 };
 
-static int mgValue[6] = { 82, 337, 365, 477, 1025,  0};
+static constexpr int mgValue[6] = { 82, 337, 365, 477, 1025,  0};
 
-static int egValue[6] = { 94, 281, 297, 512,  936,  0};
+static constexpr int egValue[6] = { 94, 281, 297, 512,  936,  0};
 
 inline void mirror(int &square){square = 56 - (8*(square/8)) + square%8;};
 
-int pieceValue(int piece, int sideToMove, float gamePhase, int square);
-float evaluate(const std::vector<uint64_t> &bitBoards, float gamePhase);
-int countMaterial(int piece, int sideToMove, float gamePhase, uint64_t bitBoard);
\ No newline at end of file
+// Middlegame and endgame values packed in a single int (endgame in the upper half), so that both
+// are updated with one addition. The lower half is signed, hence the rounding when unpacking the upper
+constexpr int makeScore(int mg, int eg){return int((unsigned int)eg << 16) + mg;};
+inline int mgScore(int score){return int16_t(uint16_t(unsigned(score)));};
+inline int egScore(int score){return int16_t(uint16_t(unsigned(score + 0x8000) >> 16));};
+
+// Material plus piece-square value of every piece on every square, positive for white and negative for black
+struct PsqtTable {
+    int score[2][8][64];
+};
+extern const PsqtTable psqt;
+
+// The game phase goes from 0 in the endgame to MAX_PHASE with all the pieces on the board
+const int MAX_PHASE = 256;
+
+int pieceValue(int piece, int sideToMove, int gamePhase, int square);
+Score evaluate(int psqtScore, int gamePhase);
+// Static evaluation from the side to move's point of view: the network of the board when it has one,
+// the tapered piece-square score otherwise
+Score evaluate(const ChessBoard &pos);
\ No newline at end of file
@@ -0,0 +1,48 @@
+#include "History.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+
+void History::clear()
+{
+    std::memset(m_butterfly, 0, sizeof(m_butterfly));
+    std::memset(m_continuation, 0, sizeof(m_continuation));
+    std::fill(&m_counterMoves[0][0], &m_counterMoves[0][0] + 8 * 64, ChessMove());
+}
+
+int History::quietScore(ChessMove t_move, int t_side, ChessMove t_previous) const
+{
+    int score = m_butterfly[t_side][t_move.getButterflyIndex()];
+    if(t_previous != ChessMove())
+        score += m_continuation[t_previous.getPiece()][t_previous.getEndSquare()][t_move.getPiece()][t_move.getEndSquare()];
+    return score;
+}
+
+ChessMove History::counterMove(ChessMove t_previous) const
+{
+    return m_counterMoves[t_previous.getPiece()][t_previous.getEndSquare()];
+}
+
+void History::update(ChessMove t_best, const ChessMove *t_quiets, int t_quietCount, int t_side, ChessMove t_previous, int t_depth)
+{
+    int bonus = std::min(16 * t_depth * t_depth, 1600);
+    bool hasPrevious = t_previous != ChessMove();
+
+    applyBonus(m_butterfly[t_side][t_best.getButterflyIndex()], bonus);
+    if(hasPrevious) applyBonus(m_continuation[t_previous.getPiece()][t_previous.getEndSquare()][t_best.getPiece()][t_best.getEndSquare()], bonus);
+
+    for(int i = 0; i < t_quietCount; i ++){
+        ChessMove move = t_quiets[i];
+        if(move == t_best) continue;
+        applyBonus(m_butterfly[t_side][move.getButterflyIndex()], -bonus);
+        if(hasPrevious) applyBonus(m_continuation[t_previous.getPiece()][t_previous.getEndSquare()][move.getPiece()][move.getEndSquare()], -bonus);
+    }
+
+    if(hasPrevious) m_counterMoves[t_previous.getPiece()][t_previous.getEndSquare()] = t_best;
+}
+
+void History::applyBonus(int16_t &t_entry, int t_bonus)
+{
+    t_entry += t_bonus - t_entry * std::abs(t_bonus) / c_maxHistory;
+}
@@ -0,0 +1,35 @@
+#pragma once
+
+#include <cstdint>
+
+#include "ChessMove.h"
+
+// Quiet move statistics gathered by one search thread: a butterfly table indexed by side and from-to squares,
+// the move that last refuted each previous move (counter moves) and a continuation table indexed by the
+// previous move and the current one. Entries are updated with gravity, each bonus is scaled down as the entry
+// approaches c_maxHistory, so values stay bounded and old statistics fade instead of saturating
+class History
+{
+public:
+    History() = default;
+    ~History() = default;
+
+public:
+    void clear();
+
+    int quietScore(ChessMove t_move, int t_side, ChessMove t_previous) const;
+    ChessMove counterMove(ChessMove t_previous) const;
+
+    // rewards the quiet move that caused a cutoff and penalizes the quiets searched before it
+    void update(ChessMove t_best, const ChessMove *t_quiets, int t_quietCount, int t_side, ChessMove t_previous, int t_depth);
+
+    static constexpr int c_maxHistory = 16384;
+
+private:
+    static void applyBonus(int16_t &t_entry, int t_bonus);
+
+private:
+    int16_t m_butterfly[2][4096];
+    ChessMove m_counterMoves[8][64];
+    int16_t m_continuation[8][64][8][64];
+};
@@ -1,12 +1,22 @@
 #pragma once
 
 #include <cstdint>
+#include "AttackTables.h"
 #include "utils.h"
 
+// With BMI2 (the x86-64-v3 build) sliders are looked up with PEXT, which packs the masked occupancy straight
+// into a dense index with no multiply. The magic tables are still generated so that the two can be benchmarked
+#if defined(__BMI2__)
+#define USE_PEXT
+#include <immintrin.h>
+#endif
+
+// Stateless view over the generated attackTables. The instance has no data and a constexpr constructor,
+// so it is constant initialized: getInstance involves no guard variable and cannot race
 class LookupTables
 {
 public:
-    static LookupTables& getInstance();
+    static const LookupTables& getInstance();
 
     LookupTables(const LookupTables&)               = delete;
     LookupTables& operator=(const LookupTables&)    = delete;
@@ -16,45 +26,41 @@ public:
     uint64_t rookXRays(int t_square) const;
     uint64_t bishopXRays(int t_square) const;
 
-    inline uint64_t knightAttacks(int t_square) const {return m_knightAttacks[t_square];}
-    inline uint64_t kingAttacks(int t_square) const {return m_kingAttacks[t_square];}
-    inline uint64_t pawnPushes(int t_square, int t_sideToMove) const {return m_pawnPushes[t_square][t_sideToMove];}
-    inline uint64_t pawnAttacks(int t_square, int t_sideToMove) const {return m_pawnAttacks[t_square][t_sideToMove];}
-    inline uint64_t knightAttacks(uint64_t t_occupied, int t_square) const {return m_knightAttacks[t_square];}
-    inline uint64_t kingAttacks(uint64_t t_occupied, int t_square) const {return m_kingAttacks[t_square];}
-    inline uint64_t rookAttacks(uint64_t t_occupied, int t_square) const {return m_rMagicDb[t_square][((t_occupied & m_rMask[t_square]) * m_rMagic[t_square]) >> m_rShift[t_square]];}
-    inline uint64_t bishopAttacks(uint64_t t_occupied, int t_square) const {return m_bMagicDb[t_square][((t_occupied & m_bMask[t_square]) * m_bMagic[t_square]) >> m_bShift[t_square]];}
-    inline uint64_t queenAttacks(uint64_t t_occupied, int t_square) const {return rookAttacks(t_occupied, t_square) | bishopAttacks(t_occupied, t_square);}
-private:
-    LookupTables();
-    ~LookupTables() = default;
+    inline uint64_t between(int t_from, int t_to) const {return attackTables.between[t_from][t_to];}
+    inline uint64_t line(int t_from, int t_to) const {return attackTables.line[t_from][t_to];}
 
-    void initRayAttacks();
-    void initKnightAttacks();
-    void initKingAttacks();
-    void initPawnAttacks();
-    void initPopCount256();
-    void initMagicMoves();
+    inline uint64_t knightAttacks(int t_square) const {return attackTables.knightAttacks[t_square];}
+    inline uint64_t kingAttacks(int t_square) const {return attackTables.kingAttacks[t_square];}
+    inline uint64_t pawnPushes(int t_square, int t_sideToMove) const {return attackTables.pawnPushes[t_square][t_sideToMove];}
+    inline uint64_t pawnAttacks(int t_square, int t_sideToMove) const {return attackTables.pawnAttacks[t_square][t_sideToMove];}
+    inline uint64_t knightAttacks([[maybe_unused]] uint64_t t_occupied, int t_square) const {return attackTables.knightAttacks[t_square];}
+    inline uint64_t kingAttacks([[maybe_unused]] uint64_t t_occupied, int t_square) const {return attackTables.kingAttacks[t_square];}
+#ifdef USE_PEXT
+    inline uint64_t rookAttacks(uint64_t t_occupied, int t_square) const {return rookAttacksPext(t_occupied, t_square);}
+    inline uint64_t bishopAttacks(uint64_t t_occupied, int t_square) const {return bishopAttacksPext(t_occupied, t_square);}
+#else
+    inline uint64_t rookAttacks(uint64_t t_occupied, int t_square) const {return rookAttacksMagic(t_occupied, t_square);}
+    inline uint64_t bishopAttacks(uint64_t t_occupied, int t_square) const {return bishopAttacksMagic(t_occupied, t_square);}
+#endif
+    inline uint64_t queenAttacks(uint64_t t_occupied, int t_square) const {return rookAttacks(t_occupied, t_square) | bishopAttacks(t_occupied, t_square);}
 
-    uint64_t initMagicOcc(int *, int, uint64_t);
-    uint64_t initMagicBMoves(int, uint64_t);
-    uint64_t initMagicRMoves(int, uint64_t);
+    inline uint64_t rookAttacksMagic(uint64_t t_occupied, int t_square) const {
+        const AttackTables &t = attackTables;
+        return t.rMagicDb[t_square][((t_occupied & t.rMask[t_square]) * t.rMagic[t_square]) >> t.rShift[t_square]];
+    }
+    inline uint64_t bishopAttacksMagic(uint64_t t_occupied, int t_square) const {
+        const AttackTables &t = attackTables;
+        return t.bMagicDb[t_square][((t_occupied & t.bMask[t_square]) * t.bMagic[t_square]) >> t.bShift[t_square]];
+    }
+#ifdef USE_PEXT
+    inline uint64_t rookAttacksPext(uint64_t t_occupied, int t_square) const {
+        return attackTables.rPextDb[attackTables.rPextOffset[t_square] + _pext_u64(t_occupied, attackTables.rMask[t_square])];
+    }
+    inline uint64_t bishopAttacksPext(uint64_t t_occupied, int t_square) const {
+        return attackTables.bPextDb[attackTables.bPextOffset[t_square] + _pext_u64(t_occupied, attackTables.bMask[t_square])];
+    }
+#endif
 private:
-    static LookupTables* m_instance;
-
-    uint64_t m_rayAttacks[64][8]; 
-    uint64_t m_knightAttacks[64];
-    uint64_t m_kingAttacks[64];
-    uint64_t m_pawnAttacks[64][2];
-    uint64_t m_pawnPushes[64][2];
-
-    const unsigned int m_rShift[64];
-    const uint64_t m_rMask[64];
-    const uint64_t m_rMagic[64];
-    const unsigned int m_bShift[64];
-    const uint64_t m_bMask[64];
-    const uint64_t m_bMagic[64];
-
-    uint64_t m_rMagicDb[64][1<<12];
-    uint64_t m_bMagicDb[64][1<<9];
+    constexpr LookupTables() = default;
+    ~LookupTables() = default;
 };
@@ -0,0 +1,28 @@
+#pragma once
+
+#include "ChessMove.h"
+
+// Fixed capacity move container meant to live on the stack, so that generating moves never allocates
+class MoveList
+{
+public:
+    MoveList() = default;
+    ~MoveList() = default;
+
+    MoveList(const MoveList&)               = delete;
+    MoveList& operator=(const MoveList&)    = delete;
+
+public:
+    inline void emplace_back(ChessMove t_move) {m_moves[m_size ++] = t_move;};
+    inline void clear() {m_size = 0;};
+    inline int size() const {return m_size;};
+    inline ChessMove& operator[](int t_index) {return m_moves[t_index];};
+    inline ChessMove* begin() {return m_moves;};
+    inline ChessMove* end() {return m_moves + m_size;};
+
+    static constexpr int c_capacity = 256; // over the maximum number of moves possible for any legal position
+
+private:
+    ChessMove m_moves[c_capacity];
+    int m_size = 0;
+};
@@ -0,0 +1,147 @@
+#include "MovePicker.h"
+#include "Evaluation.h"
+#include "notation.h"
+
+#include <utility>
+
+namespace
+{
+    // among captures that do not lose material, the most valuable victims taken by the cheapest pieces come first;
+    // the queen promotions generated with them have no victim
+    int captureOrderEval(const ChessMove &move, int sideToMove, int gamePhase){
+        int res = (move.isCapture() ? pieceValue(move.getCaptured(), 1 - sideToMove, gamePhase, move.getEndSquare()) : 0)
+            - pieceValue(move.getPiece(), sideToMove, gamePhase, move.getStartingSquare());
+
+        return res + (move.isPromo() ? pieceValue(move.getPromoPiece(), sideToMove, gamePhase, move.getEndSquare()) : 0);
+    }
+
+    int staticMoveEval(const ChessMove &move, int sideToMove, int gamePhase){
+        return pieceValue(move.isPromo() ? move.getPromoPiece() : move.getPiece(), sideToMove, gamePhase, move.getEndSquare())
+            - pieceValue(move.getPiece(), sideToMove, gamePhase, move.getStartingSquare());
+    }
+}
+
+MovePicker::MovePicker(ChessBoard &t_board, uint16_t t_hashMove, const ChessMove *t_killers, const History &t_history, ChessMove t_previous) :
+    m_board{t_board}, m_stage{hashMoveStage}, m_capturesOnly{false}, m_gamePhase{t_board.getGamePhase()},
+    m_history{&t_history}, m_previous{t_previous}
+{
+    if(!(t_hashMove && m_board.decodeMove(t_hashMove, m_hashMove))){
+        m_hashMove = ChessMove();
+        m_stage = captureGenStage;
+    }
+    if(t_killers != nullptr){
+        m_killers[0] = t_killers[0];
+        m_killers[1] = t_killers[1];
+    }
+    if(t_previous != ChessMove()) m_counterMove = t_history.counterMove(t_previous);
+}
+
+MovePicker::MovePicker(ChessBoard &t_board, bool t_capturesOnly) :
+    m_board{t_board}, m_stage{captureGenStage}, m_capturesOnly{t_capturesOnly}, m_gamePhase{t_board.getGamePhase()}
+{
+}
+
+bool MovePicker::nextMove(ChessMove &t_out)
+{
+    while(true){
+        switch (m_stage)
+        {
+        case hashMoveStage:
+            m_stage = captureGenStage;
+            t_out = m_hashMove;
+            return true;
+
+        case captureGenStage:
+            m_board.generateCaptures(m_moves);
+            m_capturesEnd = m_moves.size();
+            for(int i = 0; i < m_capturesEnd; i ++){
+                m_scores[i] = captureOrderEval(m_moves[i], m_board.getSideToMove(), m_gamePhase);
+                if(!m_board.see(m_moves[i], 0)) m_scores[i] += c_badCapture;
+            }
+            m_stage = goodCaptureStage;
+            break;
+
+        case goodCaptureStage:
+            while(m_current < m_capturesEnd){
+                pickBest(m_current, m_capturesEnd);
+                if(m_scores[m_current] < c_badCapture / 2) break;
+                ChessMove move = m_moves[m_current ++];
+                if(move != m_hashMove){
+                    t_out = move;
+                    return true;
+                }
+            }
+            m_badCaptures = m_current;
+            // quiescence only looks at captures and queen promotions that do not lose material
+            m_stage = m_capturesOnly ? doneStage : killerStage;
+            break;
+
+        case killerStage:
+            while(m_killerIndex < 2){
+                ChessMove killer = m_killers[m_killerIndex ++];
+                if(!killer.isCapture() && killer != m_hashMove && m_board.decodeMove(killer.asShort(), t_out)) return true;
+            }
+            m_stage = counterMoveStage;
+            break;
+
+        case counterMoveStage:
+            m_stage = quietGenStage;
+            if(!m_counterMove.isCapture() && m_counterMove != m_hashMove && m_counterMove != m_killers[0] && m_counterMove != m_killers[1]
+                && m_board.decodeMove(m_counterMove.asShort(), t_out)) return true;
+            break;
+
+        case quietGenStage:
+            m_board.generateQuiets(m_moves);
+            // the square table delta only breaks ties between moves the history knows nothing about
+            for(int i = m_capturesEnd; i < m_moves.size(); i ++)
+                m_scores[i] = (m_history ? m_history->quietScore(m_moves[i], m_board.getSideToMove(), m_previous) : 0)
+                    + staticMoveEval(m_moves[i], m_board.getSideToMove(), m_gamePhase);
+            m_current = m_capturesEnd;
+            m_stage = quietStage;
+            break;
+
+        case quietStage:
+            while(m_current < m_moves.size()){
+                pickBest(m_current, m_moves.size());
+                ChessMove move = m_moves[m_current ++];
+                if(!alreadyPicked(move)){
+                    t_out = move;
+                    return true;
+                }
+            }
+            m_current = m_badCaptures;
+            m_stage = badCaptureStage;
+            break;
+
+        case badCaptureStage:
+            while(m_current < m_capturesEnd){
+                pickBest(m_current, m_capturesEnd);
+                ChessMove move = m_moves[m_current ++];
+                if(move != m_hashMove){
+                    t_out = move;
+                    return true;
+                }
+            }
+            m_stage = doneStage;
+            break;
+
+        default:
+            return false;
+        }
+    }
+}
+
+void MovePicker::pickBest(int t_begin, int t_end)
+{
+    int best = t_begin;
+    for(int i = t_begin + 1; i < t_end; i ++)
+        if(m_scores[i] > m_scores[best]) best = i;
+
+    std::swap(m_moves[t_begin], m_moves[best]);
+    std::swap(m_scores[t_begin], m_scores[best]);
+}
+
+bool MovePicker::alreadyPicked(ChessMove t_move) const
+{
+    return t_move == m_hashMove || t_move == m_killers[0] || t_move == m_killers[1] || t_move == m_counterMove;
+}
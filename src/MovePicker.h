@@ -0,0 +1,55 @@
+#pragma once
+
+#include <cstdint>
+
+#include "ChessBoard.h"
+#include "History.h"
+#include "MoveList.h"
+
+// Hands out the legal moves of a position one at a time, in stages: hash move, good captures (queen
+// promotions included), killers, counter move, quiets ordered by history and finally bad captures, those that
+// lose material by static exchange evaluation.
+// Each stage is generated only when reached and moves are picked by partial selection, so a node
+// that cuts off early neither generates nor sorts the rest.
+class MovePicker
+{
+public:
+    MovePicker(ChessBoard &t_board, uint16_t t_hashMove, const ChessMove *t_killers, const History &t_history, ChessMove t_previous);
+    MovePicker(ChessBoard &t_board, bool t_capturesOnly);
+    ~MovePicker() = default;
+
+    MovePicker(const MovePicker&)               = delete;
+    MovePicker& operator=(const MovePicker&)    = delete;
+
+public:
+    bool nextMove(ChessMove &t_out);
+
+private:
+    enum Stage {
+        hashMoveStage, captureGenStage, goodCaptureStage, killerStage, counterMoveStage, quietGenStage, quietStage, badCaptureStage, doneStage
+    };
+
+    static constexpr int c_badCapture = -0x10000;
+
+    void pickBest(int t_begin, int t_end);
+    bool alreadyPicked(ChessMove t_move) const;
+
+private:
+    ChessBoard &m_board;
+    int m_stage;
+    bool m_capturesOnly;
+    int m_gamePhase;
+
+    ChessMove m_hashMove;
+    ChessMove m_killers[2];
+    int m_killerIndex = 0;
+    ChessMove m_counterMove;
+    const History *m_history = nullptr;
+    ChessMove m_previous;
+
+    int m_current = 0;
+    int m_badCaptures = 0;
+    int m_capturesEnd = 0;
+    MoveList m_moves;
+    int m_scores[MoveList::c_capacity];
+};
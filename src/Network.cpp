@@ -0,0 +1,203 @@
+#include "Network.h"
+#include "utils.h"
+
+#include <algorithm>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <vector>
+
+#if defined(__AVX2__) || defined(__SSE2__)
+#include <immintrin.h>
+#endif
+
+namespace
+{
+    const Network *activeNetwork = nullptr;
+
+    // the same input seen by black: sides swapped and board flipped vertically
+    inline int flip(int t_feature) {return (t_feature < 384 ? t_feature + 384 : t_feature - 384) ^ 56;}
+
+    // Each kernel walks a row of NNUE_HIDDEN values in vector sized chunks. The builds differ only in the
+    // vector width: AVX2 for x86-64-v3, SSE2 for the older levels and plain loops anywhere else
+#if defined(__AVX2__)
+    using Vector = __m256i;
+    const int c_lanes = 16;
+    inline Vector load(const int16_t *t_data) {return _mm256_load_si256(reinterpret_cast<const Vector*>(t_data));}
+    inline void store(int16_t *t_data, Vector t_value) {_mm256_store_si256(reinterpret_cast<Vector*>(t_data), t_value);}
+    inline Vector add16(Vector a, Vector b) {return _mm256_add_epi16(a, b);}
+    inline Vector sub16(Vector a, Vector b) {return _mm256_sub_epi16(a, b);}
+    inline Vector clip16(Vector a, int t_max) {return _mm256_min_epi16(_mm256_max_epi16(a, _mm256_setzero_si256()), _mm256_set1_epi16(t_max));}
+    // products of adjacent int16 pairs summed into int32 lanes
+    inline Vector multiplyAdd(Vector t_sum, Vector a, Vector b) {return _mm256_add_epi32(t_sum, _mm256_madd_epi16(a, b));}
+    inline Vector zero() {return _mm256_setzero_si256();}
+    inline int horizontalSum(Vector t_sum){
+        __m128i sum = _mm_add_epi32(_mm256_castsi256_si128(t_sum), _mm256_extracti128_si256(t_sum, 1));
+        sum = _mm_add_epi32(sum, _mm_shuffle_epi32(sum, _MM_SHUFFLE(1, 0, 3, 2)));
+        sum = _mm_add_epi32(sum, _mm_shuffle_epi32(sum, _MM_SHUFFLE(2, 3, 0, 1)));
+        return _mm_cvtsi128_si32(sum);
+    }
+#elif defined(__SSE2__)
+    using Vector = __m128i;
+    const int c_lanes = 8;
+    inline Vector load(const int16_t *t_data) {return _mm_load_si128(reinterpret_cast<const Vector*>(t_data));}
+    inline void store(int16_t *t_data, Vector t_value) {_mm_store_si128(reinterpret_cast<Vector*>(t_data), t_value);}
+    inline Vector add16(Vector a, Vector b) {return _mm_add_epi16(a, b);}
+    inline Vector sub16(Vector a, Vector b) {return _mm_sub_epi16(a, b);}
+    inline Vector clip16(Vector a, int t_max) {return _mm_min_epi16(_mm_max_epi16(a, _mm_setzero_si128()), _mm_set1_epi16(t_max));}
+    inline Vector multiplyAdd(Vector t_sum, Vector a, Vector b) {return _mm_add_epi32(t_sum, _mm_madd_epi16(a, b));}
+    inline Vector zero() {return _mm_setzero_si128();}
+    inline int horizontalSum(Vector t_sum){
+        t_sum = _mm_add_epi32(t_sum, _mm_shuffle_epi32(t_sum, _MM_SHUFFLE(1, 0, 3, 2)));
+        t_sum = _mm_add_epi32(t_sum, _mm_shuffle_epi32(t_sum, _MM_SHUFFLE(2, 3, 0, 1)));
+        return _mm_cvtsi128_si32(t_sum);
+    }
+#endif
+
+    void addColumns(int16_t *t_to, const int16_t *t_from, const int16_t *const *t_added, int t_addedCount,
+        const int16_t *const *t_removed, int t_removedCount)
+    {
+#if defined(__AVX2__) || defined(__SSE2__)
+        for(int i = 0; i < NNUE_HIDDEN; i += c_lanes){
+            Vector value = load(t_from + i);
+            for(int j = 0; j < t_addedCount; j ++) value = add16(value, load(t_added[j] + i));
+            for(int j = 0; j < t_removedCount; j ++) value = sub16(value, load(t_removed[j] + i));
+            store(t_to + i, value);
+        }
+#else
+        for(int i = 0; i < NNUE_HIDDEN; i ++){
+            int value = t_from[i];
+            for(int j = 0; j < t_addedCount; j ++) value += t_added[j][i];
+            for(int j = 0; j < t_removedCount; j ++) value -= t_removed[j][i];
+            t_to[i] = int16_t(value);
+        }
+#endif
+    }
+
+    int clippedDot(const int16_t *t_values, const int16_t *t_weights, int t_max)
+    {
+#if defined(__AVX2__) || defined(__SSE2__)
+        Vector sum = zero();
+        for(int i = 0; i < NNUE_HIDDEN; i += c_lanes)
+            sum = multiplyAdd(sum, clip16(load(t_values + i), t_max), load(t_weights + i));
+        return horizontalSum(sum);
+#else
+        int sum = 0;
+        for(int i = 0; i < NNUE_HIDDEN; i ++) sum += std::clamp<int>(t_values[i], 0, t_max) * t_weights[i];
+        return sum;
+#endif
+    }
+}
+
+AccumulatorStack::AccumulatorStack(const AccumulatorStack &t_other)
+{
+    *this = t_other;
+}
+
+AccumulatorStack& AccumulatorStack::operator=(const AccumulatorStack &t_other)
+{
+    if(this == &t_other) return *this;
+    if(!t_other.m_entries) m_entries.reset();
+    else {
+        if(!m_entries) allocate();
+        std::copy(t_other.m_entries.get(), t_other.m_entries.get() + MAX_PLY, m_entries.get());
+    }
+    return *this;
+}
+
+void AccumulatorStack::allocate()
+{
+    m_entries = std::make_unique<Accumulator[]>(MAX_PLY);
+}
+
+const Network *Network::load(const std::string &t_path)
+{
+    static std::mutex mutex;
+    static std::vector<std::unique_ptr<Network>> loaded;
+
+    std::ifstream file(t_path, std::ios::binary | std::ios::ate);
+    if(!file) throw std::runtime_error("cannot open the network " + t_path);
+
+    // the file is read straight into the arrays, which assumes a little endian machine like the trainers
+    std::unique_ptr<Network> network(new Network);
+    const std::streamoff expected = sizeof(m_featureWeights) + sizeof(m_featureBiases) + sizeof(m_outputWeights)
+        + sizeof(m_outputBias);
+    std::streamoff size = file.tellg();
+    if(size < expected || size > expected + 64)
+        throw std::runtime_error("the network " + t_path + " does not have the 768->256x2->1 layout");
+
+    file.seekg(0);
+    file.read(reinterpret_cast<char*>(network->m_featureWeights), sizeof(m_featureWeights));
+    file.read(reinterpret_cast<char*>(network->m_featureBiases), sizeof(m_featureBiases));
+    file.read(reinterpret_cast<char*>(network->m_outputWeights), sizeof(m_outputWeights));
+    file.read(reinterpret_cast<char*>(&network->m_outputBias), sizeof(m_outputBias));
+    if(!file) throw std::runtime_error("cannot read the network " + t_path);
+
+    std::lock_guard<std::mutex> lock(mutex);
+    loaded.push_back(std::move(network));
+    return loaded.back().get();
+}
+
+void Network::setActive(const Network *t_network)
+{
+    activeNetwork = t_network;
+}
+
+const Network *Network::getActive()
+{
+    return activeNetwork;
+}
+
+const char *Network::kernelName()
+{
+#if defined(__AVX2__)
+    return "avx2";
+#elif defined(__SSE2__)
+    return "sse2";
+#else
+    return "scalar";
+#endif
+}
+
+// Accumulator of a position computed from scratch, t_bitBoards indexed as in ChessBoard
+void Network::refresh(const uint64_t *t_bitBoards, Accumulator &t_accumulator) const
+{
+    const int16_t *columns[2][64];
+    int count = 0;
+    for(int side = white; side <= black; side ++){
+        for(int piece = pawns; piece <= kings; piece ++){
+            uint64_t pieceSet = t_bitBoards[piece] & t_bitBoards[side];
+            if(pieceSet) do {
+                int feature = FeatureDelta::feature(side, piece, btw::bitScanForward(pieceSet));
+                columns[white][count] = m_featureWeights[feature];
+                columns[black][count] = m_featureWeights[flip(feature)];
+                count ++;
+            } while(pieceSet &= (pieceSet - 1));
+        }
+    }
+    for(int perspective = white; perspective <= black; perspective ++)
+        addColumns(t_accumulator.values[perspective], m_featureBiases, columns[perspective], count, nullptr, 0);
+}
+
+void Network::update(const Accumulator &t_from, Accumulator &t_to, const FeatureDelta &t_delta) const
+{
+    const int16_t *added[2], *removed[2];
+    for(int perspective = white; perspective <= black; perspective ++){
+        for(int i = 0; i < t_delta.addedCount; i ++)
+            added[i] = m_featureWeights[perspective == white ? t_delta.added[i] : flip(t_delta.added[i])];
+        for(int i = 0; i < t_delta.removedCount; i ++)
+            removed[i] = m_featureWeights[perspective == white ? t_delta.removed[i] : flip(t_delta.removed[i])];
+        addColumns(t_to.values[perspective], t_from.values[perspective], added, t_delta.addedCount,
+            removed, t_delta.removedCount);
+    }
+}
+
+// Score of the position for the side to move, kept short of the mate scores
+Score Network::evaluate(const Accumulator &t_accumulator, int t_sideToMove) const
+{
+    int sum = clippedDot(t_accumulator.values[t_sideToMove], m_outputWeights[0], c_activationMax)
+        + clippedDot(t_accumulator.values[1 - t_sideToMove], m_outputWeights[1], c_activationMax) + m_outputBias;
+    int64_t score = int64_t(sum) * c_evalScale / (c_activationMax * c_outputScale);
+    return Score(std::clamp<int64_t>(score, -MATE_BOUND + 1, MATE_BOUND - 1));
+}
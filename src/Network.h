@@ -0,0 +1,93 @@
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <string>
+
+#include "notation.h"
+
+// Efficiently updatable neural network evaluation. The 768 inputs are one per side, piece and square; they feed
+// a hidden layer that is computed twice, once from each side's point of view (own pieces first, the board
+// flipped for black). That layer is the accumulator kept by ChessBoard, and since a move only changes a few
+// inputs makeMove updates it by adding and subtracting weight columns instead of computing it again. The
+// output neuron reads the clipped accumulators of the side to move and of its opponent
+const int NNUE_INPUTS = 768;
+const int NNUE_HIDDEN = 256;
+
+struct alignas(64) Accumulator
+{
+    int16_t values[2][NNUE_HIDDEN];     // indexed by the side whose point of view it is
+};
+
+// One accumulator per ply, indexed by the game ply and wrapping every MAX_PLY plies: the search never goes
+// deeper than that, so the entries it steps back to are never overwritten. The storage is only allocated for
+// boards that evaluate with a network, an empty stack costs a null pointer and copies nothing
+class AccumulatorStack
+{
+public:
+    AccumulatorStack() = default;
+    AccumulatorStack(const AccumulatorStack &t_other);
+    AccumulatorStack& operator=(const AccumulatorStack &t_other);
+    ~AccumulatorStack() = default;
+
+public:
+    void allocate();
+    inline Accumulator &operator[](int t_ply) {return m_entries[t_ply & c_mask];};
+    inline const Accumulator &operator[](int t_ply) const {return m_entries[t_ply & c_mask];};
+
+private:
+    static constexpr int c_mask = MAX_PLY - 1;
+    static_assert((MAX_PLY & c_mask) == 0, "MAX_PLY must be a power of two");
+
+    std::unique_ptr<Accumulator[]> m_entries;
+};
+
+// Inputs switched on and off by a move, as white sees them: side * 384 + (piece - pawns) * 64 + square
+struct FeatureDelta
+{
+    int added[2];
+    int removed[2];
+    int addedCount = 0;
+    int removedCount = 0;
+
+    inline void add(int t_side, int t_piece, int t_square) {added[addedCount ++] = feature(t_side, t_piece, t_square);};
+    inline void remove(int t_side, int t_piece, int t_square) {removed[removedCount ++] = feature(t_side, t_piece, t_square);};
+    static inline int feature(int t_side, int t_piece, int t_square) {return t_side * 384 + (t_piece - 2) * 64 + t_square;};
+};
+
+// Weights quantized to int16 so that the accumulator arithmetic runs 16 (AVX2) or 8 (SSE2) lanes at a time.
+// A loaded network is immutable and stays in memory until exit: boards only keep a pointer to the one active
+// when they were set up, so loading another never changes the evaluation of a board already set up
+class Network
+{
+public:
+    Network(const Network&)               = delete;
+    Network& operator=(const Network&)    = delete;
+
+public:
+    // Reads the raw little endian int16 layout written by common trainers for a 768->256x2->1 network:
+    // input weights [768][256], input biases [256], output weights [2][256], output bias, then up to
+    // 64 bytes of padding. Throws std::runtime_error when the file is missing or has another size
+    static const Network *load(const std::string &t_path);
+    // the network boards built from now on evaluate with, nullptr for the piece-square evaluation
+    static void setActive(const Network *t_network);
+    static const Network *getActive();
+    // instruction set of the accumulator kernels this build was compiled with
+    static const char *kernelName();
+
+    void refresh(const uint64_t *t_bitBoards, Accumulator &t_accumulator) const;
+    void update(const Accumulator &t_from, Accumulator &t_to, const FeatureDelta &t_delta) const;
+    Score evaluate(const Accumulator &t_accumulator, int t_sideToMove) const;
+
+private:
+    Network() = default;
+
+    static constexpr int c_activationMax = 255;     // hidden values are clipped to [0, 255]
+    static constexpr int c_outputScale = 64;        // quantization of the output weights
+    static constexpr int c_evalScale = 400;         // centipawns per unit of network output
+
+    alignas(64) int16_t m_featureWeights[NNUE_INPUTS][NNUE_HIDDEN];
+    alignas(64) int16_t m_featureBiases[NNUE_HIDDEN];
+    alignas(64) int16_t m_outputWeights[2][NNUE_HIDDEN];
+    int16_t m_outputBias;
+};
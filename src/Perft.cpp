@@ -0,0 +1,142 @@
+#include "Perft.h"
+#include "MoveList.h"
+
+#include <chrono>
+#include <iomanip>
+#include <stdexcept>
+
+namespace
+{
+    struct PerftPosition
+    {
+        const char *name;
+        const char *fen;
+        int depth;
+        uint64_t nodes;
+    };
+
+    const PerftPosition perftSuite[] = {
+        {"start position", "rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1", 5, 4865609},
+        {"kiwipete", "r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - 0 1", 4, 4085603},
+        {"cpw position 3", "8/2p5/3p4/KP5r/1R3p1k/8/4P1P1/8 w - - 0 1", 6, 11030083},
+        {"cpw position 4", "r3k2r/Pppp1ppp/1b3nbN/nP6/BBP1P3/q4N2/Pp1P2PP/R2Q1RK1 w kq - 0 1", 5, 15833292},
+        {"cpw position 5", "rnbq1k1r/pp1Pbppp/2p5/8/2B5/8/PPP1NnPP/RNBQK2R w KQ - 1 8", 4, 2103487},
+        {"cpw position 6", "r4rk1/1pp1qppp/p1np1n2/2b1p1B1/2B1P1b1/P1NP1N2/1PP1QPPP/R4RK1 w - - 0 10", 4, 3894594},
+        {"illegal ep move 1", "3k4/3p4/8/K1P4r/8/8/8/8 b - - 0 1", 6, 1134888},
+        {"illegal ep move 2", "8/8/4k3/8/2p5/8/B2P2K1/8 w - - 0 1", 6, 1015133},
+        {"ep capture checks opponent", "8/8/1k6/2b5/2pP4/8/5K2/8 b - d3 0 1", 6, 1440467},
+        {"ep square without a pawn", "4k3/8/8/3P4/8/8/8/4K3 w - e6 0 1", 6, 59345},
+        {"short castling gives check", "5k2/8/8/8/8/8/8/4K2R w K - 0 1", 6, 661072},
+        {"long castling gives check", "3k4/8/8/8/8/8/8/R3K3 w Q - 0 1", 6, 803711},
+        {"castling rights", "r3k2r/1b4bq/8/8/8/8/7B/R3K2R w KQkq - 0 1", 4, 1274206},
+        {"castling prevented", "r3k2r/8/3Q4/8/8/5q2/8/R3K2R b KQkq - 0 1", 4, 1720476},
+        {"promote out of check", "2K2r2/4P3/8/8/8/8/8/3k4 w - - 0 1", 6, 3821001},
+        {"discovered check", "8/8/1P2K3/8/2n5/1q6/8/5k2 b - - 0 1", 5, 1004658},
+        {"promote to give check", "4k3/1P6/8/8/8/8/K7/8 w - - 0 1", 6, 217342},
+        {"underpromote to check", "8/P1k5/K7/8/8/8/8/8 w - - 0 1", 6, 92683},
+        {"self stalemate", "K1k5/8/P7/8/8/8/8/8 w - - 0 1", 6, 2217},
+        {"stalemate and checkmate 1", "8/k1P5/8/1K6/8/8/8/8 w - - 0 1", 7, 567584},
+        {"stalemate and checkmate 2", "8/8/2k5/5q2/5n2/8/5K2/8 b - - 0 1", 4, 23527}
+    };
+
+    struct RejectedFen
+    {
+        const char *name;
+        const char *fen;
+    };
+
+    // positions the FEN parser has to refuse, since the move generator assumes they cannot happen
+    const RejectedFen rejectedFens[] = {
+        {"missing king", "8/8/8/8/8/8/8/4K3 w - - 0 1"},
+        {"ep square on the wrong rank", "4k3/8/8/3Pp3/8/8/8/4K3 w - e5 0 1"},
+        {"side not to move in check", "4k3/8/8/8/8/8/4R3/4K3 w - - 0 1"},
+        {"pawn on the last rank", "3Pk3/8/8/8/8/8/8/4K3 b - - 0 1"},
+        {"pawn on the first rank", "4k3/8/8/8/8/8/8/p3K3 w - - 0 1"}
+    };
+}
+
+uint64_t perft(ChessBoard &t_board, int t_depth)
+{
+    if(t_depth == 0) return 1;
+
+    MoveList moveList;
+    t_board.generateCaptures(moveList);
+    t_board.generateQuiets(moveList);
+
+    // the moves are legal, so the leaves are counted in bulk without being made
+    if(t_depth == 1) return moveList.size();
+
+    uint64_t nodes = 0;
+    for(ChessMove move : moveList){
+        t_board.makeMove(move);
+        nodes += perft(t_board, t_depth - 1);
+        t_board.undoMove(move);
+    }
+
+    return nodes;
+}
+
+uint64_t divide(ChessBoard &t_board, int t_depth, std::ostream &os)
+{
+    if(t_depth == 0) return 1;
+
+    MoveList moveList;
+    t_board.generateCaptures(moveList);
+    t_board.generateQuiets(moveList);
+
+    uint64_t nodes = 0;
+    for(ChessMove move : moveList){
+        t_board.makeMove(move);
+        uint64_t moveNodes = perft(t_board, t_depth - 1);
+        os << move.getNotation() << ": " << moveNodes << std::endl;
+        nodes += moveNodes;
+        t_board.undoMove(move);
+    }
+
+    os << "nodes: " << nodes << std::endl;
+    return nodes;
+}
+
+bool runPerftSuite(std::ostream &os)
+{
+    bool passed = true;
+    uint64_t totalNodes = 0;
+    double totalTime = 0;
+
+    for(const PerftPosition &position : perftSuite){
+        ChessBoard board(position.fen);
+
+        auto start = std::chrono::high_resolution_clock::now();
+        uint64_t nodes = perft(board, position.depth);
+        auto end = std::chrono::high_resolution_clock::now();
+        std::chrono::duration<double> elapsed = end - start;
+
+        bool correct = nodes == position.nodes;
+        passed = passed && correct;
+        totalNodes += nodes;
+        totalTime += elapsed.count();
+
+        os << std::left << std::setw(28) << position.name << " depth " << position.depth
+            << std::right << std::setw(12) << nodes << (correct ? "  ok    " : "  FAIL  ")
+            << std::setw(10) << uint64_t(nodes / elapsed.count()) << " nps";
+        if(!correct) os << " (expected " << position.nodes << ")";
+        os << std::endl;
+    }
+
+    for(const RejectedFen &position : rejectedFens){
+        bool rejected = false;
+        try {
+            ChessBoard board(position.fen);
+        }
+        catch(const std::invalid_argument &) {
+            rejected = true;
+        }
+        passed = passed && rejected;
+        os << std::left << std::setw(28) << position.name << " rejected" << (rejected ? "  ok" : "  FAIL") << std::endl;
+    }
+
+    os << "total " << totalNodes << " nodes in " << totalTime << "s, "
+        << uint64_t(totalNodes / totalTime) << " nps" << std::endl;
+
+    return passed;
+}
@@ -0,0 +1,17 @@
+#pragma once
+
+#include <cstdint>
+#include <iostream>
+
+#include "ChessBoard.h"
+
+// Number of leaf nodes of the legal move tree of the given depth
+uint64_t perft(ChessBoard &t_board, int t_depth);
+
+// Same as perft, also printing the node count below each root move
+uint64_t divide(ChessBoard &t_board, int t_depth, std::ostream &os);
+
+// Runs perft on a set of positions with known node counts, covering castling, en passant and
+// promotion edge cases, checks that malformed or impossible FENs are rejected and reports the move
+// generator throughput. Returns false on any mismatch.
+bool runPerftSuite(std::ostream &os);
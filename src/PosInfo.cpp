@@ -83,3 +83,9 @@ void PosInfo::resetHalfmoveClock()
 {
     info &= 0xffffe000;
 }
+
+void PosInfo::setHalfmoveClock(int t_clock)
+{
+    info &= 0xffffe000;
+    info |= t_clock & 0x1fff;
+}
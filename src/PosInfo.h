@@ -24,10 +24,12 @@ public:
     bool getShortCastlingRights(int t_sideToMove) const;
     void removeLongCastlingRights(int t_sideToMove);
     void removeShortCastlingRights(int t_sideToMove);
+    inline int getCastlingRights() const {return (info >> 13) & 0x0f;};
 
     int getHalfmoveClock() const;
     void incrementHalfmoveClock();
     void resetHalfmoveClock();
+    void setHalfmoveClock(int t_clock);
 
     inline int getInfo() const {return info >> 13;};
 };
@@ -0,0 +1,482 @@
+#include "Search.h"
+#include "Evaluation.h"
+#include "MovePicker.h"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <fstream>
+#include <iomanip>
+#include <sstream>
+
+namespace
+{
+    // helper threads skip some iterations so that they spread over neighbouring depths instead of all
+    // searching the same tree as the main thread, the pattern repeats every 20 helpers
+    const int skipSize[20]  = {1, 1, 2, 2, 2, 2, 3, 3, 3, 3, 3, 3, 4, 4, 4, 4, 4, 4, 4, 4};
+    const int skipPhase[20] = {0, 1, 0, 1, 2, 3, 0, 1, 2, 3, 4, 5, 0, 1, 2, 3, 4, 5, 6, 7};
+
+    // half width of the first aspiration window, in centipawns
+    const int aspirationWindow = 25;
+
+    // late move reductions grow with the logarithm of both the remaining depth and the move number
+    const auto lmrReductions = []{
+        std::array<std::array<int, 64>, 64> table{};
+        for(int depth = 1; depth < 64; depth ++)
+            for(int moves = 1; moves < 64; moves ++)
+                table[depth][moves] = int(0.75 + std::log(depth) * std::log(moves) / 2.25);
+        return table;
+    }();
+}
+
+Search::Search(TranspositionTable &t_table, Reporter t_reporter) :
+    m_table{t_table}, m_reporter{std::move(t_reporter)}
+{
+    setThreads(1);
+}
+
+Search::~Search()
+{
+    stop();
+    wait();
+}
+
+void Search::start(const ChessBoard &t_board, const SearchLimits &t_limits)
+{
+    wait();
+
+    m_limits = t_limits;
+    m_stop = false;
+    m_ponder = t_limits.ponder;
+    m_time.init(t_limits, t_board.getSideToMove());
+    m_table.newSearch();
+    for(auto &worker : m_workers){
+        worker->m_board = t_board;
+        worker->m_nodes = 0;
+        worker->m_pv.clear();
+        worker->m_score = 0;
+        worker->m_stats = SearchStats();
+    }
+
+    m_thread = std::thread(&Search::think, this);
+}
+
+void Search::stop()
+{
+    m_stop = true;
+}
+
+void Search::ponderHit()
+{
+    m_ponder = false;
+}
+
+void Search::wait()
+{
+    if(m_thread.joinable()) m_thread.join();
+}
+
+void Search::setThreads(int t_threads)
+{
+    wait();
+    m_workers.clear();
+    for(int i = 0; i < t_threads; i ++) m_workers.push_back(std::make_unique<Worker>(*this, i));
+}
+
+void Search::clearHistory()
+{
+    wait();
+    for(auto &worker : m_workers){
+        std::fill(&worker->m_killerMoves[0][0], &worker->m_killerMoves[0][0] + MAX_PLY * 2, ChessMove());
+        worker->m_history.clear();
+    }
+}
+
+void Search::setFeatures(const SearchFeatures &t_features)
+{
+    wait();
+    m_features = t_features;
+}
+
+uint64_t Search::getNodes() const
+{
+    uint64_t nodes = 0;
+    for(const auto &worker : m_workers) nodes += worker->m_nodes.load(std::memory_order_relaxed);
+    return nodes;
+}
+
+ChessMove Search::getBestMove() const
+{
+    const std::vector<ChessMove> &pv = m_workers[0]->m_pv;
+    return pv.empty() ? ChessMove() : pv[0];
+}
+
+Score Search::getScore() const
+{
+    return m_workers[0]->m_score;
+}
+
+SearchStats Search::getStats() const
+{
+    // the iterations are those of the main thread, helpers skip some depths
+    SearchStats stats = m_workers[0]->m_stats;
+    for(size_t i = 1; i < m_workers.size(); i ++) stats.add(m_workers[i]->m_stats);
+    return stats;
+}
+
+double Search::firstMoveCutoffRate() const
+{
+    SearchStats stats = getStats();
+    return stats.cutoffs ? double(stats.firstMoveCutoffs) / stats.cutoffs : 0;
+}
+
+void Search::setStatsLog(const std::string &t_path)
+{
+    wait();
+    m_statsLog = t_path;
+}
+
+void Search::think()
+{
+    std::vector<std::thread> helpers;
+    for(size_t i = 1; i < m_workers.size(); i ++) helpers.emplace_back(&Worker::search, m_workers[i].get());
+
+    Worker &main = *m_workers[0];
+    main.search();
+    std::vector<ChessMove> &pv = main.m_pv;
+
+    // stopped before the first iteration completed, any legal move is better than none
+    if(pv.empty()){
+        MoveList moves;
+        main.m_board.generateCaptures(moves);
+        main.m_board.generateQuiets(moves);
+        if(moves.size() > 0) pv.push_back(moves[0]);
+    }
+
+    // while pondering or in infinite mode the gui expects the best move only after it sent stop or ponderhit
+    while(!m_stop && (m_ponder || m_limits.infinite))
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+
+    m_stop = true;
+    for(auto &helper : helpers) helper.join();
+
+    reportStats(main.m_board.toFEN(), pv.empty() ? std::string("0000") : pv[0].getNotation());
+
+    std::string bestMove = "bestmove " + (pv.empty() ? std::string("0000") : pv[0].getNotation());
+    if(pv.size() > 1) bestMove += " ponder " + pv[1].getNotation();
+    m_reporter(bestMove);
+}
+
+Search::Worker::Worker(Search &t_search, int t_id) :
+    m_search{t_search}, m_id{t_id}
+{
+    m_history.clear();
+}
+
+void Search::Worker::search()
+{
+    Score score = 0;
+
+    for(int depth = 1; depth < MAX_PLY; depth ++){
+        if(skipDepth(depth)) continue;
+
+        // from depth 4 the last score is a good guess, so the window starts narrow around it and doubles on
+        // every failure; a mate score is searched with the full window, as a narrow one would fail anyway
+        int delta = aspirationWindow;
+        Score alpha = -INF_SCORE, beta = INF_SCORE;
+        if(depth >= 4 && std::abs(score) < MATE_BOUND){
+            alpha = std::max(score - delta, -INF_SCORE);
+            beta = std::min(score + delta, +INF_SCORE);
+        }
+
+        while(true){
+            // the root only fills its line when a move raises alpha, so a fail low keeps the last pv, and a
+            // root move that raised alpha in an aborted iteration was searched completely and is kept
+            Score res = alphaBeta(m_board, 0, depth, alpha, beta);
+            if(m_pvLength[0] > 0) m_pv.assign(m_pvTable[0], m_pvTable[0] + m_pvLength[0]);
+            if(m_search.m_stop) return;
+            if(m_id == 0) m_search.report(depth, res, alpha, beta, m_pv);
+
+            // the failed bound widens away from the score, the other one stays close to it, and the
+            // transposition table hands the re-search the best move of the failed one first
+            if(res <= alpha){
+                beta = (alpha + beta) / 2;
+                alpha = std::max(res - delta, -INF_SCORE);
+            }
+            else if(res >= beta) beta = std::min(res + delta, +INF_SCORE);
+            else {
+                score = res;
+                break;
+            }
+            delta += delta;
+        }
+
+        if(m_pv.empty()) return;   // no legal move at the root
+        m_score = score;
+        m_stats.completedDepth = depth;
+        m_stats.iterationNodes[depth] = m_nodes.load(std::memory_order_relaxed);
+
+        // helpers keep searching deeper until the main thread is done
+        if(m_id == 0){
+            m_search.m_time.update(m_pv[0], score);
+            if(depth == m_search.m_limits.depth) return;
+            // an iteration started past the soft limit would most likely be aborted before completing
+            if(!m_search.m_ponder && m_search.m_time.softLimitReached()) return;
+        }
+    }
+}
+
+Score Search::Worker::alphaBeta(ChessBoard &pos, int ply, int depth, Score alpha, Score beta)
+{
+    m_pvLength[ply] = 0;
+    if(shouldStop()) return 0;
+    m_stats.nodes ++;
+    if(ply > 0 && pos.isDraw(ply)) return 0;
+
+    m_stats.ttProbes ++;
+    Value val;
+    bool hashHit = m_search.m_table.getValue(pos.getKey(), ply, val);
+    m_stats.ttHits += hashHit;
+    if(ply > 0 && hashHit && (val.depth >= depth || val.nodeType == endNode)){
+        if(val.nodeType == pvNode || val.nodeType == endNode || (val.nodeType == allNode && val.score <= alpha)
+            || (val.nodeType == cutNode && val.score >= beta)){
+            m_stats.ttCutoffs ++;
+            return val.score;
+        }
+    }
+
+    if(depth == 0){
+        Score score = quiescence(pos, ply, alpha, beta);
+        return score;
+    }
+
+    const SearchFeatures &features = m_search.m_features;
+    bool isPvNode = beta - alpha > 1;
+    bool posIsCheck = pos.isCheck();
+    ChessMove previous = ply > 0 ? m_playedMoves[ply - 1] : ChessMove();
+
+    // if passing the turn still fails high the position is good enough to cut without searching any move.
+    // Zugzwang breaks this assumption, so the side to move must have pieces other than pawns, and deep
+    // cutoffs are verified by a reduced search with null moves disabled for the first plies of its subtree
+    if(features.nullMove && !isPvNode && !posIsCheck && ply > 0 && previous != ChessMove() && depth >= 3
+        && ply >= m_nullMoveMinPly && pos.getNonPawnMaterial(pos.getSideToMove()) > 0
+        && evaluate(pos) >= beta){
+        int reduction = 3 + depth / 6;
+        m_playedMoves[ply] = ChessMove();
+        m_stats.nullMoveTries ++;
+        pos.makeNullMove();
+        Score score = -alphaBeta(pos, ply + 1, std::max(0, depth - 1 - reduction), -beta, -beta + 1);
+        pos.undoNullMove();
+        if(m_search.m_stop) return 0;
+
+        if(score >= beta){
+            if(score >= MATE_BOUND) score = beta;   // a mate found after passing proves nothing
+            if(depth < 10){
+                m_stats.nullMoveCutoffs ++;
+                return score;
+            }
+
+            int minPly = m_nullMoveMinPly;
+            m_nullMoveMinPly = ply + 3 * (depth - reduction) / 4;
+            Score verified = alphaBeta(pos, ply, depth - reduction, beta - 1, beta);
+            m_nullMoveMinPly = minPly;
+            if(m_search.m_stop) return 0;
+            if(verified >= beta){
+                m_stats.nullMoveCutoffs ++;
+                return score;
+            }
+        }
+    }
+
+    Score bestScore = -INF_SCORE;
+    int nodeType = allNode;
+    int movesSearched = 0;
+    ChessMove move, bestMove;
+    ChessMove quietsSearched[64];
+    int quietCount = 0;
+
+    // the hash move comes first, so a cutoff on it skips move generation entirely
+    MovePicker picker(pos, hashHit ? val.move : 0, m_killerMoves[ply], m_history, previous);
+
+    while(nodeType != cutNode && picker.nextMove(move)){
+        movesSearched ++;
+        bool isQuiet = !move.isCapture() && !move.isPromo();
+        m_playedMoves[ply] = move;
+        pos.makeMove(move);
+        Score score;
+
+        if(movesSearched == 1) score = -alphaBeta(pos, ply + 1, depth - 1, -beta, -alpha);
+        else {
+            // late quiet moves are searched shallower first and only at full depth when they beat alpha
+            int reduction = 0;
+            if(features.lateMoveReductions && depth >= 3 && isQuiet && !posIsCheck && !pos.isCheck()){
+                reduction = lmrReductions[std::min(depth, 63)][std::min(movesSearched, 63)] - isPvNode;
+                reduction = std::clamp(reduction, 0, depth - 2);
+            }
+
+            // with pvs every move after the first is only expected to fail low, which a null window proves
+            // cheaply; the full window is searched again when one turns out better
+            Score scoutBeta = features.pvs ? alpha + 1 : beta;
+            score = -alphaBeta(pos, ply + 1, depth - 1 - reduction, -scoutBeta, -alpha);
+            m_stats.lmrSearches += reduction > 0;
+            if(score > alpha && reduction > 0){
+                m_stats.lmrReSearches ++;
+                score = -alphaBeta(pos, ply + 1, depth - 1, -scoutBeta, -alpha);
+            }
+            if(score > alpha && score < beta && scoutBeta != beta){
+                score = -alphaBeta(pos, ply + 1, depth - 1, -beta, -alpha);
+            }
+        }
+        pos.undoMove(move);
+        if(isQuiet && quietCount < 64) quietsSearched[quietCount ++] = move;
+
+        // an interrupted subtree returns garbage, so nothing of it may reach the table or the pv
+        if(m_search.m_stop) return 0;
+
+        if(score > bestScore){
+            bestScore = score;
+            if(bestScore > alpha) {
+                alpha = bestScore;
+                nodeType = alpha >= beta ? cutNode : pvNode;
+                bestMove = move;
+
+                // the line of this ply is the move followed by the line the child just left one row below
+                m_pvTable[ply][0] = move;
+                std::copy(m_pvTable[ply + 1], m_pvTable[ply + 1] + m_pvLength[ply + 1], m_pvTable[ply] + 1);
+                m_pvLength[ply] = m_pvLength[ply + 1] + 1;
+            }
+        }
+    }
+
+    if(nodeType == cutNode){
+        m_stats.cutoffs ++;
+        if(movesSearched == 1) m_stats.firstMoveCutoffs ++;
+
+        if(!bestMove.isCapture() && !bestMove.isPromo()){
+            if(bestMove != m_killerMoves[ply][0]){
+                m_killerMoves[ply][1] = m_killerMoves[ply][0];
+                m_killerMoves[ply][0] = bestMove;
+            }
+            m_history.update(bestMove, quietsSearched, quietCount, pos.getSideToMove(), previous, depth);
+        }
+    }
+
+    if(movesSearched == 0) {
+        bestScore = posIsCheck ? matedIn(ply) : 0;
+        nodeType = endNode;
+    }
+
+    // a fail low has no best move, the one already stored is still the best guess for a re-search
+    uint16_t hashMove = bestMove != ChessMove() ? bestMove.asShort() : hashHit ? val.move : 0;
+    m_search.m_table.insert(pos.getKey(), ply, bestScore, depth, nodeType, hashMove);
+    return bestScore;
+}
+
+Score Search::Worker::quiescence(ChessBoard &pos, int ply, Score alpha, Score beta)
+{
+    if(shouldStop()) return 0;
+    m_stats.qnodes ++;
+
+    // the board keeps the network accumulators of MAX_PLY plies only, so the search stops short of that
+    if(ply >= MAX_PLY - 1) return evaluate(pos);
+
+    bool evadeChecks = pos.isCheck();
+    bool unableToMove = true;
+    Score bestScore  = evadeChecks ? -INF_SCORE : evaluate(pos);
+
+    if(bestScore >= beta) return bestScore;
+    if(bestScore > alpha) alpha = bestScore;
+
+    // when in check every move is searched, as they must just be legal
+    MovePicker picker(pos, !evadeChecks);
+    ChessMove move;
+
+    while(alpha < beta && picker.nextMove(move)){
+        unableToMove = false;
+        pos.makeMove(move);
+        Score score = - quiescence(pos, ply + 1, -beta, -alpha);
+        pos.undoMove(move);
+        if(score > bestScore){
+            bestScore = score;
+            if(score > alpha) alpha = bestScore;
+        }
+    }
+
+    if(evadeChecks && unableToMove) bestScore = matedIn(ply);
+
+    return bestScore;
+}
+
+bool Search::Worker::shouldStop()
+{
+    uint64_t nodes = m_nodes.load(std::memory_order_relaxed) + 1;
+    m_nodes.store(nodes, std::memory_order_relaxed);
+
+    // reading the clock is far slower than searching a node, so it is only done every 1024 nodes
+    if(m_id == 0 && (nodes & 1023) == 0 && !m_search.m_ponder){
+        if(m_search.m_limits.nodes && m_search.getNodes() >= m_search.m_limits.nodes) m_search.m_stop = true;
+        else if(m_search.m_time.hardLimitReached()) m_search.m_stop = true;
+    }
+    return m_search.m_stop.load(std::memory_order_relaxed);
+}
+
+bool Search::Worker::skipDepth(int depth) const
+{
+    if(m_id == 0) return false;
+    int i = (m_id - 1) % 20;
+    return ((depth + skipPhase[i]) / skipSize[i]) % 2 != 0;
+}
+
+void Search::report(int depth, Score score, Score alpha, Score beta, const std::vector<ChessMove> &pv) const
+{
+    int64_t time = m_time.elapsed();
+    std::ostringstream info;
+    info << "info depth " << depth << " score ";
+
+    if(score >= MATE_BOUND) info << "mate " << (CHECKMATE - score + 1) / 2;
+    else if(score <= -MATE_BOUND) info << "mate " << -(CHECKMATE + score) / 2;
+    else info << "cp " << score;
+
+    if(score <= alpha) info << " upperbound";
+    else if(score >= beta) info << " lowerbound";
+
+    uint64_t nodes = getNodes();
+    info << " nodes " << nodes << " nps " << nodes * 1000 / std::max<int64_t>(1, time) << " hashfull " << m_table.hashfull()
+        << " time " << time << " pv";
+    for(ChessMove move : pv) info << " " << move.getNotation();
+
+    m_reporter(info.str());
+}
+
+// Sent once the threads are done, just before bestmove: the summary as an info line for the gui and
+// as a json record for whoever collects them
+void Search::reportStats(const std::string &t_fen, const std::string &t_bestMove) const
+{
+    SearchStats stats = getStats();
+    int64_t time = m_time.elapsed();
+    uint64_t nodes = getNodes();
+    uint64_t nps = nodes * 1000 / std::max<int64_t>(1, time);
+    int hashfull = m_table.hashfull();
+
+    std::ostringstream info;
+    info << "info nodes " << nodes << " nps " << nps << " hashfull " << hashfull << " time " << time;
+    m_reporter(info.str());
+
+    auto percent = [](uint64_t part, uint64_t whole){ return whole ? 100.0 * part / whole : 0.0; };
+    std::ostringstream summary;
+    summary << std::fixed << std::setprecision(1) << "info string stats qnodes " << stats.qnodes
+        << " tthits " << percent(stats.ttHits, stats.ttProbes) << "% ttcutoffs " << stats.ttCutoffs
+        << " firstmovecutoffs " << percent(stats.firstMoveCutoffs, stats.cutoffs)
+        << "% nullmove " << stats.nullMoveCutoffs << "/" << stats.nullMoveTries
+        << " lmr " << stats.lmrSearches - stats.lmrReSearches << "/" << stats.lmrSearches
+        << std::setprecision(2) << " ebf " << stats.branchingFactor(stats.completedDepth);
+    m_reporter(summary.str());
+
+    if(m_statsLog.empty()) return;
+    std::ofstream log(m_statsLog, std::ios::app);
+    log << "{\"fen\":\"" << t_fen << "\",\"bestmove\":\"" << t_bestMove << "\",\"threads\":" << m_workers.size()
+        << ",\"time_ms\":" << time << ",\"nps\":" << nps << ",\"hashfull\":" << hashfull << ",";
+    stats.writeJson(log);
+    log << "}" << std::endl;
+    if(!log) m_reporter("info string cannot write the stats log " + m_statsLog);
+}
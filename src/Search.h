@@ -0,0 +1,112 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "ChessBoard.h"
+#include "ChessMove.h"
+#include "History.h"
+#include "SearchStats.h"
+#include "TimeManager.h"
+#include "TranspositionTable.h"
+#include "notation.h"
+
+// Pruning and reduction techniques that can be turned off at runtime, to measure what each one saves
+struct SearchFeatures
+{
+    bool pvs = true;
+    bool nullMove = true;
+    bool lateMoveReductions = true;
+};
+
+// Runs the iterative deepening search on its own thread. Every line meant for the gui (info and bestmove)
+// is handed to the reporter, the search polls an atomic flag so that stop() is honoured within a few nodes.
+// With more than one thread the helpers search the same root (lazy smp) and only share the transposition
+// table, the main thread alone reports and decides the best move
+class Search
+{
+public:
+    using Reporter = std::function<void(const std::string&)>;
+
+    Search(TranspositionTable &t_table, Reporter t_reporter);
+    ~Search();
+
+    Search(const Search&)               = delete;
+    Search& operator=(const Search&)    = delete;
+
+public:
+    void start(const ChessBoard &t_board, const SearchLimits &t_limits);
+    void stop();
+    void ponderHit();
+    void wait();
+
+    void setThreads(int t_threads);
+    void clearHistory();
+    void setFeatures(const SearchFeatures &t_features);
+    // where the search output goes: optionally one json record per search appended to a file
+    void setStatsLog(const std::string &t_path);
+    uint64_t getNodes() const;
+    // result of the last search once it has finished: the move it played and the score of the last completed
+    // iteration, from the side to move
+    ChessMove getBestMove() const;
+    Score getScore() const;
+    // counters of the last search summed over the threads, only meaningful once it has finished
+    SearchStats getStats() const;
+    // share of the cutoffs of the last search produced by the first move tried, a measure of move ordering
+    double firstMoveCutoffRate() const;
+
+private:
+    // State owned by a single thread: its own copy of the position and its own move ordering tables
+    class Worker
+    {
+    public:
+        Worker(Search &t_search, int t_id);
+
+        // iterative deepening with aspiration windows, leaves the best line found in m_pv
+        void search();
+        Score alphaBeta(ChessBoard &pos, int ply, int depth, Score alpha, Score beta);
+        Score quiescence(ChessBoard &pos, int ply, Score alpha, Score beta);
+
+        bool shouldStop();
+        bool skipDepth(int depth) const;
+
+    public:
+        Search &m_search;
+        const int m_id;
+        ChessBoard m_board;
+        std::atomic<uint64_t> m_nodes{0};
+        std::vector<ChessMove> m_pv;       // principal variation of the last completed search, root move first
+        Score m_score = 0;
+        // triangular pv table: row ply holds the best line found from that ply, m_pvLength[ply] moves long
+        ChessMove m_pvTable[MAX_PLY + 1][MAX_PLY + 1];
+        int m_pvLength[MAX_PLY + 1];
+        ChessMove m_killerMoves[MAX_PLY][2];
+        ChessMove m_playedMoves[MAX_PLY];
+        int m_nullMoveMinPly = 0;
+        History m_history;
+
+        SearchStats m_stats;
+    };
+
+    void think();
+    void report(int depth, Score score, Score alpha, Score beta, const std::vector<ChessMove> &pv) const;
+    void reportStats(const std::string &t_fen, const std::string &t_bestMove) const;
+
+private:
+    TranspositionTable &m_table;
+    Reporter m_reporter;
+    std::thread m_thread;
+    std::atomic<bool> m_stop{false};
+    std::atomic<bool> m_ponder{false};
+
+    SearchLimits m_limits;
+    SearchFeatures m_features;
+    std::string m_statsLog;
+    TimeManager m_time;
+    std::vector<std::unique_ptr<Worker>> m_workers;
+};
@@ -0,0 +1,37 @@
+#include "SearchStats.h"
+
+void SearchStats::add(const SearchStats &t_other)
+{
+    nodes += t_other.nodes;
+    qnodes += t_other.qnodes;
+    ttProbes += t_other.ttProbes;
+    ttHits += t_other.ttHits;
+    ttCutoffs += t_other.ttCutoffs;
+    cutoffs += t_other.cutoffs;
+    firstMoveCutoffs += t_other.firstMoveCutoffs;
+    nullMoveTries += t_other.nullMoveTries;
+    nullMoveCutoffs += t_other.nullMoveCutoffs;
+    lmrSearches += t_other.lmrSearches;
+    lmrReSearches += t_other.lmrReSearches;
+}
+
+double SearchStats::branchingFactor(int t_depth) const
+{
+    if(t_depth < 2 || t_depth > completedDepth) return 0;
+    uint64_t current = iterationNodes[t_depth] - iterationNodes[t_depth - 1];
+    uint64_t previous = iterationNodes[t_depth - 1] - iterationNodes[t_depth - 2];
+    return previous ? double(current) / previous : 0;
+}
+
+void SearchStats::writeJson(std::ostream &os) const
+{
+    os << "\"nodes\":" << nodes << ",\"qnodes\":" << qnodes
+        << ",\"tt_probes\":" << ttProbes << ",\"tt_hits\":" << ttHits << ",\"tt_cutoffs\":" << ttCutoffs
+        << ",\"cutoffs\":" << cutoffs << ",\"first_move_cutoffs\":" << firstMoveCutoffs
+        << ",\"null_move_tries\":" << nullMoveTries << ",\"null_move_cutoffs\":" << nullMoveCutoffs
+        << ",\"lmr_searches\":" << lmrSearches << ",\"lmr_researches\":" << lmrReSearches
+        << ",\"depth\":" << completedDepth << ",\"ebf\":[";
+    for(int depth = 2; depth <= completedDepth; depth ++)
+        os << (depth > 2 ? "," : "") << branchingFactor(depth);
+    os << "]";
+}
@@ -0,0 +1,32 @@
+#pragma once
+
+#include <cstdint>
+#include <ostream>
+
+#include "notation.h"
+
+// Counters of a single search. Each thread increments its own copy without synchronization and the copies
+// are only summed once the threads are done, so the instrumentation costs a plain add per event
+struct SearchStats
+{
+    uint64_t nodes = 0;             // alphaBeta nodes
+    uint64_t qnodes = 0;            // quiescence nodes
+    uint64_t ttProbes = 0;
+    uint64_t ttHits = 0;
+    uint64_t ttCutoffs = 0;
+    uint64_t cutoffs = 0;
+    uint64_t firstMoveCutoffs = 0;
+    uint64_t nullMoveTries = 0;
+    uint64_t nullMoveCutoffs = 0;
+    uint64_t lmrSearches = 0;       // reduced searches
+    uint64_t lmrReSearches = 0;     // reduced searches that beat alpha and had to be searched again at full depth
+
+    // total nodes of the main thread when each iteration completed, for the effective branching factor
+    int completedDepth = 0;
+    uint64_t iterationNodes[MAX_PLY] = {};
+
+    void add(const SearchStats &t_other);
+    // nodes of the iteration divided by those of the previous one, 0 when unknown
+    double branchingFactor(int t_depth) const;
+    void writeJson(std::ostream &os) const;
+};
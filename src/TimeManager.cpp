@@ -0,0 +1,72 @@
+#include "TimeManager.h"
+
+#include <algorithm>
+
+void TimeManager::init(const SearchLimits &t_limits, int t_sideToMove)
+{
+    m_startTime = std::chrono::steady_clock::now();
+    m_softLimit = m_hardLimit = 0;
+    m_scalable = false;
+    m_scale = 1.0;
+    m_iterations = m_stableIterations = 0;
+    m_lastBestMove = ChessMove();
+    m_lastScore = 0;
+
+    if(t_limits.infinite) return;
+
+    if(t_limits.moveTime){
+        m_softLimit = m_hardLimit = std::max<int64_t>(1, t_limits.moveTime - c_moveOverhead);
+        return;
+    }
+
+    int64_t time = t_limits.time[t_sideToMove];
+    if(time == 0) return;
+
+    int64_t available = std::max<int64_t>(1, time - c_moveOverhead);
+    int movesToGo = t_limits.movesToGo ? std::min(t_limits.movesToGo, 50) : c_defaultMovesToGo;
+    int64_t increment = t_limits.increment[t_sideToMove];
+
+    m_softLimit = std::min<int64_t>(available / movesToGo + increment * 3 / 4, available * 6 / 10);
+    m_hardLimit = std::min<int64_t>(m_softLimit * 4, available * 8 / 10);
+    m_softLimit = std::max<int64_t>(1, m_softLimit);
+    m_hardLimit = std::max<int64_t>(m_softLimit, m_hardLimit);
+    m_scalable = true;
+}
+
+void TimeManager::update(ChessMove t_bestMove, Score t_score)
+{
+    if(m_iterations ++ == 0){
+        m_lastBestMove = t_bestMove;
+        m_lastScore = t_score;
+        return;
+    }
+
+    m_stableIterations = t_bestMove == m_lastBestMove ? m_stableIterations + 1 : 0;
+
+    // an unsettled best move is worth more time, one that survived several iterations less
+    m_scale = 1.4 - 0.1 * std::min(m_stableIterations, 6);
+
+    // a falling score means trouble the search has only started to see
+    int drop = m_lastScore - t_score;
+    if(drop > 20) m_scale *= 1.0 + std::min(drop, 100) / 100.0;
+
+    m_lastBestMove = t_bestMove;
+    m_lastScore = t_score;
+}
+
+bool TimeManager::softLimitReached() const
+{
+    if(!isTimed()) return false;
+    int64_t limit = m_scalable ? std::min<int64_t>(m_hardLimit, int64_t(m_softLimit * m_scale)) : m_softLimit;
+    return elapsed() >= limit;
+}
+
+bool TimeManager::hardLimitReached() const
+{
+    return isTimed() && elapsed() >= m_hardLimit;
+}
+
+int64_t TimeManager::elapsed() const
+{
+    return std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - m_startTime).count();
+}
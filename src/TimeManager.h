@@ -0,0 +1,53 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+
+#include "ChessMove.h"
+#include "notation.h"
+
+// Limits of a single search as given by the uci "go" command, times are in milliseconds and zero means unset
+struct SearchLimits {
+    int depth = 0;
+    uint64_t nodes = 0;
+    int64_t moveTime = 0;
+    int64_t time[2] = {0, 0};
+    int64_t increment[2] = {0, 0};
+    int movesToGo = 0;
+    bool infinite = false;
+    bool ponder = false;
+};
+
+// Splits the clock into a soft limit, past which no new iteration is started, and a hard limit at which
+// the running iteration is aborted. The soft limit grows when the best move keeps changing or the score
+// drops between iterations and shrinks while the best move stays the same
+class TimeManager
+{
+public:
+    TimeManager() = default;
+    ~TimeManager() = default;
+
+public:
+    void init(const SearchLimits &t_limits, int t_sideToMove);
+    void update(ChessMove t_bestMove, Score t_score);
+
+    inline bool isTimed() const {return m_hardLimit > 0;};
+    bool softLimitReached() const;
+    bool hardLimitReached() const;
+    int64_t elapsed() const;
+
+private:
+    static constexpr int64_t c_moveOverhead = 30;   // reserved for the communication with the gui
+    static constexpr int c_defaultMovesToGo = 30;
+
+    std::chrono::steady_clock::time_point m_startTime;
+    int64_t m_softLimit = 0;
+    int64_t m_hardLimit = 0;
+    bool m_scalable = false;
+    double m_scale = 1.0;
+
+    int m_iterations = 0;
+    int m_stableIterations = 0;
+    ChessMove m_lastBestMove;
+    Score m_lastScore = 0;
+};
@@ -1,75 +1,119 @@
 #include "TranspositionTable.h"
 #include "notation.h"
 
-Value TranspositionTable::getValue(const ChessBoard &t_key)
+#include <algorithm>
+
+// data layout: move [0, 16), score [16, 32), depth [32, 40), node type [40, 42), age [42, 48), [48, 64) unused
+
+TranspositionTable::TranspositionTable(size_t t_megaBytes) : m_mask{0}, m_age{0}
 {
-    auto it = m_cache.find(t_key);
-    if (it != m_cache.end()){
-        m_contents.splice(m_contents.begin(), m_contents, it -> second);
-        return it->second->second;
-    }
-    throw std::runtime_error("ChessBoard not found");
+    resize(t_megaBytes);
 }
 
-bool TranspositionTable::getValue(const ChessBoard &t_key, Value &t_out)
+bool TranspositionTable::getValue(uint64_t t_key, int t_ply, Value &t_out) const
 {
-    auto it = m_cache.find(t_key);
-    if (it != m_cache.end()){
-        m_contents.splice(m_contents.begin(), m_contents, it -> second);
-        t_out = it->second->second;
-        return true;
+    const Bucket &bucket = m_buckets[t_key & m_mask];
+
+    for (const Entry &entry : bucket.entries){
+        uint64_t data = entry.data.load(std::memory_order_relaxed);
+        if ((entry.key.load(std::memory_order_relaxed) ^ data) == t_key){
+            Score score = Score(uint16_t(data >> 16));
+            if (score >= MATE_BOUND) score -= t_ply;
+            else if (score <= -MATE_BOUND) score += t_ply;
+
+            t_out.score = score;
+            t_out.depth = depthOf(data);
+            t_out.nodeType = (data >> 40) & 0x03;
+            t_out.move = uint16_t(data);
+            return true;
+        }
     }
     return false;
 }
 
-float TranspositionTable::getScore(const ChessBoard &t_key)
+void TranspositionTable::insert(uint64_t t_key, int t_ply, Score t_score, int t_depth, int t_nodeType, uint16_t t_move)
 {
-    auto it = m_cache.find(t_key);
-    if (it != m_cache.end()){
-        m_contents.splice(m_contents.begin(), m_contents, it -> second);
-        return it->second->second.score;
+    // a mate is stored as its distance from this node, so that it stays right when reached at another ply
+    if (t_score >= MATE_BOUND) t_score += t_ply;
+    else if (t_score <= -MATE_BOUND) t_score -= t_ply;
+
+    Bucket &bucket = m_buckets[t_key & m_mask];
+    uint64_t data = pack(t_score, t_depth, t_nodeType, t_move);
+
+    // same position already stored: keep the deeper result unless it comes from an older search
+    for (Entry &entry : bucket.entries){
+        uint64_t oldData = entry.data.load(std::memory_order_relaxed);
+        if ((entry.key.load(std::memory_order_relaxed) ^ oldData) == t_key){
+            if (t_depth >= depthOf(oldData) || ageOf(oldData) != int(m_age)) store(entry, t_key, data);
+            return;
+        }
     }
-    throw std::runtime_error("ChessBoard not found");
-}
 
-int TranspositionTable::getDepth(const ChessBoard &t_key) 
-{
-    auto it = m_cache.find(t_key);
-    if (it != m_cache.end()){
-        m_contents.splice(m_contents.begin(), m_contents, it -> second);
-        return it->second->second.depth;
+    // depth preferred slots: the victim is the shallowest entry, stale ones first
+    int victim = 0, victimWorth = 0x7fffffff;
+    for (int i = 0; i < c_alwaysReplace; i ++){
+        uint64_t oldData = bucket.entries[i].data.load(std::memory_order_relaxed);
+        int worth = depthOf(oldData) - (ageOf(oldData) != int(m_age) ? 0x100 : 0);
+        if (worth < victimWorth){
+            victim = i;
+            victimWorth = worth;
+        }
     }
-    throw std::runtime_error("ChessBoard not found");
+
+    if (t_depth >= victimWorth) store(bucket.entries[victim], t_key, data);
+    else store(bucket.entries[c_alwaysReplace], t_key, data);
 }
 
-int TranspositionTable::getNodeType(const ChessBoard &t_key)
+void TranspositionTable::resize(size_t t_megaBytes)
 {
-    auto it = m_cache.find(t_key);
-    if (it != m_cache.end()){
-        m_contents.splice(m_contents.begin(), m_contents, it -> second);
-        return it->second->second.nodeType;
-    }
-    throw std::runtime_error("ChessBoard not found");
+    size_t numBuckets = 1;
+    while (numBuckets * 2 * sizeof(Bucket) <= (t_megaBytes << 20)) numBuckets *= 2;
+
+    m_buckets.reset();
+    m_buckets.reset(new Bucket[numBuckets]());
+    m_mask = numBuckets - 1;
+    m_age = 0;
 }
 
-void TranspositionTable::insert(const ChessBoard &t_key, float t_score, int t_depth, int t_nodeType)
+void TranspositionTable::clear()
 {
-    auto it = m_cache.find(t_key);
-    if (it == m_cache.end()){
-        m_contents.emplace_front(t_key, Value{t_score, t_depth, t_nodeType});
-        m_cache[t_key] = m_contents.begin();
-        if (m_contents.size() == m_maxSize){
-            m_cache.erase(m_contents.back().first);
-            m_contents.pop_back();
+    for (uint64_t i = 0; i <= m_mask; i ++){
+        for (Entry &entry : m_buckets[i].entries){
+            entry.key.store(0, std::memory_order_relaxed);
+            entry.data.store(0, std::memory_order_relaxed);
         }
     }
-    else if(t_depth > it->second->second.depth){
-        it->second->second = Value{t_score, t_depth, t_nodeType};
-        m_contents.splice(m_contents.begin(), m_contents, it -> second);
-    }
+    m_age = 0;
+}
+
+void TranspositionTable::newSearch()
+{
+    m_age = (m_age + 1) & 0x3f;
 }
 
 size_t TranspositionTable::getSize() const
 {
-    return m_contents.size();
+    return (m_mask + 1) * c_bucketSize;
+}
+
+int TranspositionTable::hashfull() const
+{
+    int used = 0;
+    for (uint64_t i = 0; i < 1000 / c_bucketSize; i ++){
+        for (const Entry &entry : m_buckets[i & m_mask].entries)
+            if (entry.key.load(std::memory_order_relaxed) != 0 && ageOf(entry.data.load(std::memory_order_relaxed)) == int(m_age)) used ++;
+    }
+    return used;
+}
+
+uint64_t TranspositionTable::pack(Score t_score, int t_depth, int t_nodeType, uint16_t t_move) const
+{
+    return uint64_t(t_move) | uint64_t(uint16_t(t_score)) << 16 | uint64_t(std::min(t_depth, 0xff)) << 32
+        | uint64_t(t_nodeType & 0x03) << 40 | m_age << 42;
+}
+
+void TranspositionTable::store(Entry &t_entry, uint64_t t_key, uint64_t t_data)
+{
+    t_entry.key.store(t_key ^ t_data, std::memory_order_relaxed);
+    t_entry.data.store(t_data, std::memory_order_relaxed);
 }
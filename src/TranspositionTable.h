@@ -1,37 +1,67 @@
 #pragma once
 
-#include <unordered_map>
-#include <list>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
 
-#include "ChessBoard.h"
+#include "notation.h"
 
 struct Value
 {
-    float score;
+    Score score;
     int depth;
     int nodeType;
+    uint16_t move;
 };
 
-
+// Fixed size hash table made of cache line sized buckets of four 16 bytes entries.
+// Entries are written and read without locks: the key is stored xored with the data,
+// so a torn entry simply fails verification instead of returning garbage.
+// Mate scores are stored relative to the node and converted back to the root distance on probe,
+// which is why both take the ply of the node.
 class TranspositionTable
 {
 public:
-    TranspositionTable(int size):m_maxSize(size){};
+    TranspositionTable(size_t t_megaBytes);
     ~TranspositionTable() = default;
 
+    TranspositionTable(const TranspositionTable&)               = delete;
+    TranspositionTable& operator=(const TranspositionTable&)    = delete;
+
 public:
-    inline bool doesContain(const ChessBoard &t_key) const {return m_cache.find(t_key) != m_cache.end();};
-    
-    Value getValue(const ChessBoard &t_key);
-    bool getValue(const ChessBoard &t_key, Value &t_out);
-    float getScore(const ChessBoard &t_key);
-    int getDepth(const ChessBoard &t_key);
-    int getNodeType(const ChessBoard & t_key);
-    void insert(const ChessBoard &t_key, float t_value, int t_depth, int t_nodeType);
+    bool getValue(uint64_t t_key, int t_ply, Value &t_out) const;
+    void insert(uint64_t t_key, int t_ply, Score t_score, int t_depth, int t_nodeType, uint16_t t_move);
+
+    void resize(size_t t_megaBytes);
+    void clear();
+    void newSearch();
     size_t getSize() const;
+    // permill of entries written by the current search, estimated on the first thousand as uci does
+    int hashfull() const;
+
+private:
+    struct Entry
+    {
+        std::atomic<uint64_t> key;
+        std::atomic<uint64_t> data;
+    };
+
+    struct alignas(64) Bucket
+    {
+        Entry entries[4];
+    };
+
+    static constexpr int c_bucketSize = 4;
+    static constexpr int c_alwaysReplace = c_bucketSize - 1;
+
+    uint64_t pack(Score t_score, int t_depth, int t_nodeType, uint16_t t_move) const;
+    void store(Entry &t_entry, uint64_t t_key, uint64_t t_data);
+    inline static int depthOf(uint64_t t_data) {return (t_data >> 32) & 0xff;};
+    inline static int ageOf(uint64_t t_data) {return (t_data >> 42) & 0x3f;};
 
 private:
-    int m_maxSize;
-    std::list<std::pair<ChessBoard, Value>> m_contents;
-    std::unordered_map<ChessBoard, std::list<std::pair<ChessBoard, Value>>::iterator, HashFunction> m_cache;
+    std::unique_ptr<Bucket[]> m_buckets;
+    uint64_t m_mask;
+    uint64_t m_age;
 };
@@ -0,0 +1,178 @@
+#include "Uci.h"
+#include "Network.h"
+
+#include <algorithm>
+#include <iostream>
+#include <stdexcept>
+
+namespace
+{
+    const std::string startPosition = "rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1";
+
+    // finds the legal move written in long algebraic notation, as used by uci
+    bool parseMove(ChessBoard &board, const std::string &notation, ChessMove &out){
+        MoveList moves;
+        board.generateCaptures(moves);
+        board.generateQuiets(moves);
+        for(ChessMove move : moves){
+            if(move.getNotation() == notation){
+                out = move;
+                return true;
+            }
+        }
+        return false;
+    }
+}
+
+Uci::Uci(size_t t_hashMegaBytes) :
+    m_table{t_hashMegaBytes}, m_search{m_table, [this](const std::string &line){ send(line); }}
+{
+}
+
+void Uci::loop(std::istream &t_input)
+{
+    std::string line;
+    while(std::getline(t_input, line)){
+        std::istringstream command(line);
+        std::string token;
+        command >> token;
+
+        if(token == "uci"){
+            send("id name ChessEngine\n"
+                 "id author Claudio Raciti\n"
+                 "option name Hash type spin default 16 min 1 max 65536\n"
+                 "option name Threads type spin default 1 min 1 max 256\n"
+                 "option name Ponder type check default false\n"
+                 "option name PVS type check default true\n"
+                 "option name NullMove type check default true\n"
+                 "option name LMR type check default true\n"
+                 "option name StatsLog type string default <empty>\n"
+                 "option name EvalFile type string default <empty>\n"
+                 "uciok");
+        }
+        else if(token == "isready") send("readyok");
+        else if(token == "ucinewgame"){
+            m_search.stop();
+            m_search.wait();
+            m_table.clear();
+            m_search.clearHistory();
+        }
+        else if(token == "position") position(command);
+        else if(token == "go") go(command);
+        else if(token == "stop") m_search.stop();
+        else if(token == "ponderhit") m_search.ponderHit();
+        else if(token == "setoption") setOption(command);
+        else if(token == "quit") break;
+        else if(!token.empty()) send("info string unknown command " + token);
+    }
+
+    m_search.stop();
+    m_search.wait();
+}
+
+void Uci::position(std::istringstream &t_command)
+{
+    std::string token, fen;
+    t_command >> token;
+    if(token == "startpos"){
+        fen = startPosition;
+        t_command >> token;
+    }
+    else if(token == "fen"){
+        while(t_command >> token && token != "moves") fen += token + " ";
+    }
+    else return;
+
+    try {
+        m_board = ChessBoard(fen);
+    }
+    catch (const std::invalid_argument &e) {
+        send(std::string("info string ") + e.what());
+        return;
+    }
+
+    if(token != "moves") return;
+    while(t_command >> token){
+        ChessMove move;
+        if(!parseMove(m_board, token, move)){
+            send("info string illegal move " + token);
+            return;
+        }
+        m_board.makeMove(move);
+    }
+}
+
+void Uci::go(std::istringstream &t_command)
+{
+    SearchLimits limits;
+    std::string token;
+    while(t_command >> token){
+        if(token == "depth") t_command >> limits.depth;
+        else if(token == "nodes") t_command >> limits.nodes;
+        else if(token == "movetime") t_command >> limits.moveTime;
+        else if(token == "wtime") t_command >> limits.time[white];
+        else if(token == "btime") t_command >> limits.time[black];
+        else if(token == "winc") t_command >> limits.increment[white];
+        else if(token == "binc") t_command >> limits.increment[black];
+        else if(token == "movestogo") t_command >> limits.movesToGo;
+        else if(token == "infinite") limits.infinite = true;
+        else if(token == "ponder") limits.ponder = true;
+    }
+
+    // a go sent while still searching replaces the running search
+    m_search.stop();
+    m_search.start(m_board, limits);
+}
+
+void Uci::setOption(std::istringstream &t_command)
+{
+    std::string token, name, value;
+    t_command >> token;
+    if(token != "name") return;
+    while(t_command >> token && token != "value") name += (name.empty() ? "" : " ") + token;
+    t_command >> value;
+
+    try {
+        if(name == "Hash"){
+            m_search.stop();
+            m_search.wait();
+            m_table.resize(std::clamp(std::stoul(value), 1ul, 65536ul));
+        }
+        else if(name == "Threads"){
+            m_search.stop();
+            m_search.setThreads(std::clamp(std::stoi(value), 1, 256));
+        }
+        else if(name == "PVS" || name == "NullMove" || name == "LMR"){
+            if(value != "true" && value != "false") throw std::invalid_argument(value);
+            bool &feature = name == "PVS" ? m_features.pvs : name == "NullMove" ? m_features.nullMove : m_features.lateMoveReductions;
+            feature = value == "true";
+            m_search.stop();
+            m_search.setFeatures(m_features);
+        }
+        else if(name == "StatsLog"){
+            m_search.stop();
+            m_search.setStatsLog(value == "<empty>" ? "" : value);
+        }
+        else if(name == "EvalFile"){
+            // takes effect from the next position command, <empty> goes back to the piece-square evaluation
+            m_search.stop();
+            m_search.wait();
+            try {
+                Network::setActive(value == "<empty>" ? nullptr : Network::load(value));
+            }
+            catch (const std::runtime_error &e) {
+                send(std::string("info string ") + e.what());
+            }
+        }
+        else if(name != "Ponder") send("info string unknown option " + name);
+    }
+    catch (const std::logic_error &) {
+        send("info string invalid value " + value + " for option " + name);
+    }
+}
+
+void Uci::send(const std::string &t_line)
+{
+    std::lock_guard<std::mutex> lock(m_outputMutex);
+    std::cout << t_line << std::endl;
+}
@@ -0,0 +1,39 @@
+#pragma once
+
+#include <cstddef>
+#include <istream>
+#include <mutex>
+#include <sstream>
+#include <string>
+
+#include "ChessBoard.h"
+#include "Search.h"
+#include "TranspositionTable.h"
+
+// Reads uci commands and answers on std::cout. Commands are handled while the search keeps running
+// on its own thread, so stop, ponderhit and isready are answered immediately
+class Uci
+{
+public:
+    explicit Uci(size_t t_hashMegaBytes);
+    ~Uci() = default;
+
+    Uci(const Uci&)               = delete;
+    Uci& operator=(const Uci&)    = delete;
+
+public:
+    void loop(std::istream &t_input);
+
+private:
+    void position(std::istringstream &t_command);
+    void go(std::istringstream &t_command);
+    void setOption(std::istringstream &t_command);
+    void send(const std::string &t_line);
+
+private:
+    std::mutex m_outputMutex;
+    ChessBoard m_board;
+    TranspositionTable m_table;
+    Search m_search;
+    SearchFeatures m_features;
+};
@@ -0,0 +1,45 @@
+#pragma once
+
+#include <cstdint>
+
+// Zobrist keys, generated at compile time from a fixed seed so that keys
+// (and therefore hash table contents) are reproducible between runs
+namespace zobrist
+{
+    struct Keys
+    {
+        uint64_t piece[2][8][64]; // [side][pieceType][square], only pawns..kings are used
+        uint64_t castling[16];    // indexed by PosInfo::getCastlingRights()
+        uint64_t epFile[8];
+        uint64_t side;            // toggled when black is to move
+    };
+
+    constexpr uint64_t splitMix64(uint64_t &t_state)
+    {
+        uint64_t z = (t_state += 0x9e3779b97f4a7c15);
+        z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9;
+        z = (z ^ (z >> 27)) * 0x94d049bb133111eb;
+        return z ^ (z >> 31);
+    }
+
+    constexpr Keys initKeys()
+    {
+        Keys keys{};
+        uint64_t state = 0x2545f4914f6cdd1d;
+
+        for (int side = 0; side < 2; side ++)
+            for (int piece = 0; piece < 8; piece ++)
+                for (int square = 0; square < 64; square ++)
+                    keys.piece[side][piece][square] = splitMix64(state);
+
+        // no rights at all hashes to zero, so that positions without castling
+        // rights don't pay for an extra xor
+        for (int rights = 1; rights < 16; rights ++) keys.castling[rights] = splitMix64(state);
+        for (int file = 0; file < 8; file ++) keys.epFile[file] = splitMix64(state);
+        keys.side = splitMix64(state);
+
+        return keys;
+    }
+
+    inline constexpr Keys keys = initKeys();
+}; // namespace zobrist
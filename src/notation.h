@@ -1,6 +1,18 @@
 #pragma once
 
-const float CHECKMATE = 500.0f;
+#include <cstdint>
+
+const int MAX_PLY = 128;
+
+// Scores are in centipawns from the side to move's point of view. A mate is CHECKMATE minus its distance
+// in plies from the root, so every score beyond MATE_BOUND is a mate found within the search
+using Score = int16_t;
+const Score INF_SCORE = 32000;
+const Score CHECKMATE = 31000;
+const Score MATE_BOUND = CHECKMATE - MAX_PLY;
+
+inline Score mateIn(int ply) {return CHECKMATE - ply;};
+inline Score matedIn(int ply) {return -CHECKMATE + ply;};
 
 enum pieceType {
     white, black, pawns, knights, bishops, rooks, queens, kings
@@ -1,7 +1,7 @@
 #pragma once
 
-#include <cstdint>
-#include <vector>
+#include <bit>
+#include <cassert>
 #include <cstdint>
 
 // Bit TWiddling functions
@@ -15,11 +15,23 @@ namespace btw
     uint64_t cpyWrapSout(uint64_t bitBoard);
     uint64_t cpyWrapEast(uint64_t bitBoard);
     uint64_t cpyWrapWest(uint64_t bitBoard);
-    int bitScanReverse(uint64_t bitBoard);
-    int bitScanForward(uint64_t bitBoard);
 
-    static int _popCount256[256];
-    static bool _isPopCountInit = false;
-    void initPopCount256();
-    int popCount(uint64_t bitBoard);
+    // These compile to single TZCNT/LZCNT/POPCNT instructions when the target supports them (see the
+    // x86-64-v2/v3 builds in CMakeLists.txt) and to portable fallbacks otherwise
+
+    // Finds position of Least Significant 1 Bit
+    inline int bitScanForward(uint64_t bitBoard){
+        assert (bitBoard != 0);
+        return std::countr_zero(bitBoard);
+    }
+
+    // Finds position of Most Significant 1 Bit
+    inline int bitScanReverse(uint64_t bitBoard){
+        assert (bitBoard != 0);
+        return 63 - std::countl_zero(bitBoard);
+    }
+
+    inline int popCount(uint64_t bitBoard){
+        return std::popcount(bitBoard);
+    }
 }; // namespace btw
@@ -0,0 +1,24 @@
+# Runs the batch command on batch.epd and checks that the rejected position gets an error record in its
+# place while the lines around it are analyzed. Expects ENGINE and INPUT to be defined
+execute_process(COMMAND ${ENGINE} --threads 2 batch ${INPUT} depth 4
+    OUTPUT_VARIABLE output ERROR_VARIABLE log RESULT_VARIABLE result)
+if(NOT result EQUAL 0)
+    message(FATAL_ERROR "batch exited with ${result}\n${output}${log}")
+endif()
+
+# one letter per record: b for a search result, e for an error
+set(kinds "")
+string(REGEX MATCHALL "[^\n]+" records "${output}")
+foreach(record IN LISTS records)
+    if(record MATCHES "\"error\":")
+        string(APPEND kinds "e")
+    elseif(record MATCHES "\"bestmove\":")
+        string(APPEND kinds "b")
+    else()
+        string(APPEND kinds "?")
+    endif()
+endforeach()
+
+if(NOT kinds STREQUAL "bbebb" OR NOT log MATCHES "4 analyzed, 1 invalid")
+    message(FATAL_ERROR "unexpected batch output\n${output}${log}")
+endif()
@@ -0,0 +1,437 @@
+#include <algorithm>
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <string>
+
+#include "AttackTables.h"
+#include "notation.h"
+#include "utils.h"
+
+// Build time generator of the attack tables: computes every table the engine looks up and writes them
+// as the initializer of the constant `attackTables` object, so the engine never computes them at runtime
+
+namespace
+{
+    const unsigned int rShift[64] = {
+        52, 53, 53, 53, 53, 53, 53, 52,
+        53, 54, 54, 54, 54, 54, 54, 53,
+        53, 54, 54, 54, 54, 54, 54, 53,
+        53, 54, 54, 54, 54, 54, 54, 53,
+        53, 54, 54, 54, 54, 54, 54, 53,
+        53, 54, 54, 54, 54, 54, 54, 53,
+        53, 54, 54, 54, 54, 54, 54, 53,
+        53, 54, 54, 53, 53, 53, 53, 53
+    };
+
+    const uint64_t rMask[64] = {
+        uint64_t(0x000101010101017E), uint64_t(0x000202020202027C), uint64_t(0x000404040404047A), uint64_t(0x0008080808080876),
+        uint64_t(0x001010101010106E), uint64_t(0x002020202020205E), uint64_t(0x004040404040403E), uint64_t(0x008080808080807E),
+        uint64_t(0x0001010101017E00), uint64_t(0x0002020202027C00), uint64_t(0x0004040404047A00), uint64_t(0x0008080808087600),
+        uint64_t(0x0010101010106E00), uint64_t(0x0020202020205E00), uint64_t(0x0040404040403E00), uint64_t(0x0080808080807E00),
+        uint64_t(0x00010101017E0100), uint64_t(0x00020202027C0200), uint64_t(0x00040404047A0400), uint64_t(0x0008080808760800),
+        uint64_t(0x00101010106E1000), uint64_t(0x00202020205E2000), uint64_t(0x00404040403E4000), uint64_t(0x00808080807E8000),
+        uint64_t(0x000101017E010100), uint64_t(0x000202027C020200), uint64_t(0x000404047A040400), uint64_t(0x0008080876080800),
+        uint64_t(0x001010106E101000), uint64_t(0x002020205E202000), uint64_t(0x004040403E404000), uint64_t(0x008080807E808000),
+        uint64_t(0x0001017E01010100), uint64_t(0x0002027C02020200), uint64_t(0x0004047A04040400), uint64_t(0x0008087608080800),
+        uint64_t(0x0010106E10101000), uint64_t(0x0020205E20202000), uint64_t(0x0040403E40404000), uint64_t(0x0080807E80808000),
+        uint64_t(0x00017E0101010100), uint64_t(0x00027C0202020200), uint64_t(0x00047A0404040400), uint64_t(0x0008760808080800),
+        uint64_t(0x00106E1010101000), uint64_t(0x00205E2020202000), uint64_t(0x00403E4040404000), uint64_t(0x00807E8080808000),
+        uint64_t(0x007E010101010100), uint64_t(0x007C020202020200), uint64_t(0x007A040404040400), uint64_t(0x0076080808080800),
+        uint64_t(0x006E101010101000), uint64_t(0x005E202020202000), uint64_t(0x003E404040404000), uint64_t(0x007E808080808000),
+        uint64_t(0x7E01010101010100), uint64_t(0x7C02020202020200), uint64_t(0x7A04040404040400), uint64_t(0x7608080808080800),
+        uint64_t(0x6E10101010101000), uint64_t(0x5E20202020202000), uint64_t(0x3E40404040404000), uint64_t(0x7E80808080808000)
+    };
+
+    const uint64_t rMagic[64] = {
+        uint64_t(0x0080001020400080), uint64_t(0x0040001000200040), uint64_t(0x0080081000200080), uint64_t(0x0080040800100080),
+        uint64_t(0x0080020400080080), uint64_t(0x0080010200040080), uint64_t(0x0080008001000200), uint64_t(0x0080002040800100),
+        uint64_t(0x0000800020400080), uint64_t(0x0000400020005000), uint64_t(0x0000801000200080), uint64_t(0x0000800800100080),
+        uint64_t(0x0000800400080080), uint64_t(0x0000800200040080), uint64_t(0x0000800100020080), uint64_t(0x0000800040800100),
+        uint64_t(0x0000208000400080), uint64_t(0x0000404000201000), uint64_t(0x0000808010002000), uint64_t(0x0000808008001000),
+        uint64_t(0x0000808004000800), uint64_t(0x0000808002000400), uint64_t(0x0000010100020004), uint64_t(0x0000020000408104),
+        uint64_t(0x0000208080004000), uint64_t(0x0000200040005000), uint64_t(0x0000100080200080), uint64_t(0x0000080080100080),
+        uint64_t(0x0000040080080080), uint64_t(0x0000020080040080), uint64_t(0x0000010080800200), uint64_t(0x0000800080004100),
+        uint64_t(0x0000204000800080), uint64_t(0x0000200040401000), uint64_t(0x0000100080802000), uint64_t(0x0000080080801000),
+        uint64_t(0x0000040080800800), uint64_t(0x0000020080800400), uint64_t(0x0000020001010004), uint64_t(0x0000800040800100),
+        uint64_t(0x0000204000808000), uint64_t(0x0000200040008080), uint64_t(0x0000100020008080), uint64_t(0x0000080010008080),
+        uint64_t(0x0000040008008080), uint64_t(0x0000020004008080), uint64_t(0x0000010002008080), uint64_t(0x0000004081020004),
+        uint64_t(0x0000204000800080), uint64_t(0x0000200040008080), uint64_t(0x0000100020008080), uint64_t(0x0000080010008080),
+        uint64_t(0x0000040008008080), uint64_t(0x0000020004008080), uint64_t(0x0000800100020080), uint64_t(0x0000800041000080),
+        uint64_t(0x00FFFCDDFCED714A), uint64_t(0x007FFCDDFCED714A), uint64_t(0x003FFFCDFFD88096), uint64_t(0x0000040810002101),
+        uint64_t(0x0001000204080011), uint64_t(0x0001000204000801), uint64_t(0x0001000082000401), uint64_t(0x0001FFFAABFAD1A2)
+    };
+
+    const unsigned int bShift[64] = {
+        58, 59, 59, 59, 59, 59, 59, 58,
+        59, 59, 59, 59, 59, 59, 59, 59,
+        59, 59, 57, 57, 57, 57, 59, 59,
+        59, 59, 57, 55, 55, 57, 59, 59,
+        59, 59, 57, 55, 55, 57, 59, 59,
+        59, 59, 57, 57, 57, 57, 59, 59,
+        59, 59, 59, 59, 59, 59, 59, 59,
+        58, 59, 59, 59, 59, 59, 59, 58
+    };
+
+    const uint64_t bMask[64] = {
+        uint64_t(0x0040201008040200), uint64_t(0x0000402010080400), uint64_t(0x0000004020100A00), uint64_t(0x0000000040221400),
+        uint64_t(0x0000000002442800), uint64_t(0x0000000204085000), uint64_t(0x0000020408102000), uint64_t(0x0002040810204000),
+        uint64_t(0x0020100804020000), uint64_t(0x0040201008040000), uint64_t(0x00004020100A0000), uint64_t(0x0000004022140000),
+        uint64_t(0x0000000244280000), uint64_t(0x0000020408500000), uint64_t(0x0002040810200000), uint64_t(0x0004081020400000),
+        uint64_t(0x0010080402000200), uint64_t(0x0020100804000400), uint64_t(0x004020100A000A00), uint64_t(0x0000402214001400),
+        uint64_t(0x0000024428002800), uint64_t(0x0002040850005000), uint64_t(0x0004081020002000), uint64_t(0x0008102040004000),
+        uint64_t(0x0008040200020400), uint64_t(0x0010080400040800), uint64_t(0x0020100A000A1000), uint64_t(0x0040221400142200),
+        uint64_t(0x0002442800284400), uint64_t(0x0004085000500800), uint64_t(0x0008102000201000), uint64_t(0x0010204000402000),
+        uint64_t(0x0004020002040800), uint64_t(0x0008040004081000), uint64_t(0x00100A000A102000), uint64_t(0x0022140014224000),
+        uint64_t(0x0044280028440200), uint64_t(0x0008500050080400), uint64_t(0x0010200020100800), uint64_t(0x0020400040201000),
+        uint64_t(0x0002000204081000), uint64_t(0x0004000408102000), uint64_t(0x000A000A10204000), uint64_t(0x0014001422400000),
+        uint64_t(0x0028002844020000), uint64_t(0x0050005008040200), uint64_t(0x0020002010080400), uint64_t(0x0040004020100800),
+        uint64_t(0x0000020408102000), uint64_t(0x0000040810204000), uint64_t(0x00000A1020400000), uint64_t(0x0000142240000000),
+        uint64_t(0x0000284402000000), uint64_t(0x0000500804020000), uint64_t(0x0000201008040200), uint64_t(0x0000402010080400),
+        uint64_t(0x0002040810204000), uint64_t(0x0004081020400000), uint64_t(0x000A102040000000), uint64_t(0x0014224000000000),
+        uint64_t(0x0028440200000000), uint64_t(0x0050080402000000), uint64_t(0x0020100804020000), uint64_t(0x0040201008040200)
+    };
+
+    const uint64_t bMagic[64] = {
+        uint64_t(0x0002020202020200), uint64_t(0x0002020202020000), uint64_t(0x0004010202000000), uint64_t(0x0004040080000000),
+        uint64_t(0x0001104000000000), uint64_t(0x0000821040000000), uint64_t(0x0000410410400000), uint64_t(0x0000104104104000),
+        uint64_t(0x0000040404040400), uint64_t(0x0000020202020200), uint64_t(0x0000040102020000), uint64_t(0x0000040400800000),
+        uint64_t(0x0000011040000000), uint64_t(0x0000008210400000), uint64_t(0x0000004104104000), uint64_t(0x0000002082082000),
+        uint64_t(0x0004000808080800), uint64_t(0x0002000404040400), uint64_t(0x0001000202020200), uint64_t(0x0000800802004000),
+        uint64_t(0x0000800400A00000), uint64_t(0x0000200100884000), uint64_t(0x0000400082082000), uint64_t(0x0000200041041000),
+        uint64_t(0x0002080010101000), uint64_t(0x0001040008080800), uint64_t(0x0000208004010400), uint64_t(0x0000404004010200),
+        uint64_t(0x0000840000802000), uint64_t(0x0000404002011000), uint64_t(0x0000808001041000), uint64_t(0x0000404000820800),
+        uint64_t(0x0001041000202000), uint64_t(0x0000820800101000), uint64_t(0x0000104400080800), uint64_t(0x0000020080080080),
+        uint64_t(0x0000404040040100), uint64_t(0x0000808100020100), uint64_t(0x0001010100020800), uint64_t(0x0000808080010400),
+        uint64_t(0x0000820820004000), uint64_t(0x0000410410002000), uint64_t(0x0000082088001000), uint64_t(0x0000002011000800),
+        uint64_t(0x0000080100400400), uint64_t(0x0001010101000200), uint64_t(0x0002020202000400), uint64_t(0x0001010101000200),
+        uint64_t(0x0000410410400000), uint64_t(0x0000208208200000), uint64_t(0x0000002084100000), uint64_t(0x0000000020880000),
+        uint64_t(0x0000001002020000), uint64_t(0x0000040408020000), uint64_t(0x0004040404040000), uint64_t(0x0002020202020000),
+        uint64_t(0x0000104104104000), uint64_t(0x0000002082082000), uint64_t(0x0000000020841000), uint64_t(0x0000000000208800),
+        uint64_t(0x0000000010020200), uint64_t(0x0000000404080200), uint64_t(0x0000040404040400), uint64_t(0x0002020202020200)
+    };
+
+    uint64_t initMagicOcc(int *squares, int nSquares, uint64_t sequence)
+    {
+        uint64_t returnVal = 0;
+        for (int i = 0; i < nSquares; i ++)
+            if (sequence & ((uint64_t) 1 << i)) returnVal |= (uint64_t) 1 << squares[i];
+        return returnVal;
+    }
+
+    uint64_t initMagicBMoves(int t_square, uint64_t t_occupied)
+    {
+        uint64_t ret=0;
+        uint64_t bit;
+        uint64_t bit2;
+        uint64_t rowbits=(((uint64_t)0xFF)<<(8*(t_square/8)));
+
+        bit=(((uint64_t)(1))<<t_square);
+        bit2=bit;
+        do
+        {
+            bit<<=8-1;
+            bit2>>=1;
+            if(bit2&rowbits) ret|=bit;
+            else break;
+        }while(bit && !(bit&t_occupied));
+        bit=(((uint64_t)(1))<<t_square);
+        bit2=bit;
+        do
+        {
+            bit<<=8+1;
+            bit2<<=1;
+            if(bit2&rowbits) ret|=bit;
+            else break;
+        }while(bit && !(bit&t_occupied));
+        bit=(((uint64_t)(1))<<t_square);
+        bit2=bit;
+        do
+        {
+            bit>>=8-1;
+            bit2<<=1;
+            if(bit2&rowbits) ret|=bit;
+            else break;
+        }while(bit && !(bit&t_occupied));
+        bit=(((uint64_t)(1))<<t_square);
+        bit2=bit;
+        do
+        {
+            bit>>=8+1;
+            bit2>>=1;
+            if(bit2&rowbits) ret|=bit;
+            else break;
+        }while(bit && !(bit&t_occupied));
+        return ret;
+    }
+
+    uint64_t initMagicRMoves(int t_square, uint64_t t_occupied)
+    {
+        uint64_t ret=0;
+        uint64_t bit;
+        uint64_t rowbits=(((uint64_t)0xFF)<<(8*(t_square/8)));
+
+        bit=(((uint64_t)(1))<<t_square);
+        do
+        {
+            bit<<=8;
+            ret|=bit;
+        }while(bit && !(bit&t_occupied));
+        bit=(((uint64_t)(1))<<t_square);
+        do
+        {
+            bit>>=8;
+            ret|=bit;
+        }while(bit && !(bit&t_occupied));
+        bit=(((uint64_t)(1))<<t_square);
+        do
+        {
+            bit<<=1;
+            if(bit&rowbits) ret|=bit;
+            else break;
+        }while(!(bit&t_occupied));
+        bit=(((uint64_t)(1))<<t_square);
+        do
+        {
+            bit>>=1;
+            if(bit&rowbits) ret|=bit;
+            else break;
+        }while(!(bit&t_occupied));
+        return ret;
+    }
+
+    void initRayAttacks(AttackTables &t_tables)
+    {
+        uint64_t nortRay =  (uint64_t) 0x0101010101010100;
+        for (int sq = 0; sq < 64; sq ++, nortRay <<= 1)
+            t_tables.rayAttacks[sq][nort] = nortRay;
+
+
+        uint64_t noEaRay = (uint64_t) 0x8040201008040200;
+        for (int file = 0; file < 8; file ++, btw::wrapEast(noEaRay)){
+            uint64_t wrappedRay = noEaRay;
+            for (int rank = 0; rank < 8; rank ++, wrappedRay <<= 8)
+                t_tables.rayAttacks[rank * 8 + file][noEa] = wrappedRay;
+        }
+
+        uint64_t noWeRay = (uint64_t) 0x102040810204000;
+        for (int file = 7; file >= 0; file --, btw::wrapWest(noWeRay)){
+            uint64_t wrappedRay = noWeRay;
+            for (int rank = 0; rank < 8; rank ++, wrappedRay <<= 8)
+                t_tables.rayAttacks[rank * 8 + file][noWe] = wrappedRay;
+        }
+
+        uint64_t eastRay = (uint64_t) 0x0000000000000fe;
+        for (int file = 0; file < 8; file ++, btw::wrapEast(eastRay)){
+            uint64_t wrappedRay = eastRay;
+            for (int rank = 0; rank < 8; rank ++, wrappedRay <<= 8)
+                t_tables.rayAttacks[rank * 8 + file][east] = wrappedRay;
+        }
+
+        uint64_t soutRay = (uint64_t) 0x0080808080808080;
+        for (int sq = 63; sq >= 0; sq --, soutRay >>= 1)
+            t_tables.rayAttacks[sq][sout] = soutRay;
+
+        uint64_t soEaRay = (uint64_t) 0x0002040810204080;
+        for (int file = 0; file < 8; file ++, btw::wrapEast(soEaRay)){
+            uint64_t wrappedRay = soEaRay;
+            for (int rank = 7; rank >= 0; rank --, wrappedRay >>= 8)
+                t_tables.rayAttacks[rank * 8 + file][soEa] = wrappedRay;
+        }
+
+        uint64_t soWeRay = (uint64_t) 0x0040201008040201;
+        for (int file = 7; file >= 0; file --, btw::wrapWest(soWeRay)){
+            uint64_t wrappedRay = soWeRay;
+            for (int rank = 7; rank >= 0; rank --, wrappedRay >>= 8)
+                t_tables.rayAttacks[rank * 8 + file][soWe] = wrappedRay;
+        }
+
+        uint64_t westRay = (uint64_t) 0x7f00000000000000;
+        for (int file = 7; file >= 0; file --, btw::wrapWest(westRay)){
+            uint64_t wrappedRay = westRay;
+            for (int rank = 7; rank >= 0; rank --, wrappedRay >>= 8)
+                t_tables.rayAttacks[rank * 8 + file][west] = wrappedRay;
+        }
+    }
+
+    // directions are numbered so that d and 7 - d are opposite, see notation.h
+    void initLines(AttackTables &t_tables)
+    {
+        for (int from = 0; from < 64; from ++) for (int to = 0; to < 64; to ++){
+            uint64_t toMask = (uint64_t) 1 << to;
+            for (int dir = 0; dir < 8; dir ++){
+                if (!(t_tables.rayAttacks[from][dir] & toMask)) continue;
+                t_tables.between[from][to] = (t_tables.rayAttacks[from][dir] ^ t_tables.rayAttacks[to][dir]) & ~toMask;
+                t_tables.line[from][to] = t_tables.rayAttacks[from][dir] | t_tables.rayAttacks[from][7 - dir] | ((uint64_t) 1 << from);
+            }
+        }
+    }
+
+    void initKnightAttacks(AttackTables &t_tables)
+    {
+        uint64_t knightPos = (uint64_t) 1;
+        for (int sq = 0; sq < 64; sq ++, knightPos <<= 1){
+            t_tables.knightAttacks[sq] = (uint64_t) 0;
+
+            uint64_t eastDir = btw::cpyWrapEast(knightPos);
+            uint64_t eaEaDir = btw::cpyWrapEast(eastDir);
+            t_tables.knightAttacks[sq] |= eastDir << 16 | eaEaDir << 8 
+                | eastDir >> 16 | eaEaDir >> 8;
+
+            uint64_t westDir = btw::cpyWrapWest(knightPos);
+            uint64_t weWeDir = btw::cpyWrapWest(westDir);
+            t_tables.knightAttacks[sq] |= westDir << 16 | weWeDir << 8
+                | westDir >> 16 | weWeDir >> 8;
+        }
+    }
+
+    void initKingAttacks(AttackTables &t_tables)
+    {
+        uint64_t kingPosition = (uint64_t) 1;
+        for (int sq = 0; sq < 64; sq ++, kingPosition <<= 1){
+            t_tables.kingAttacks[sq] = kingPosition << 8 | kingPosition >> 8;
+            uint64_t eastDir = btw::cpyWrapEast(kingPosition);
+            t_tables.kingAttacks[sq] |= eastDir | eastDir << 8 | eastDir >> 8;
+            uint64_t westDir = btw::cpyWrapWest(kingPosition);
+            t_tables.kingAttacks[sq] |= westDir | westDir << 8 | westDir >> 8;
+        }
+    }
+
+    void initPawnAttacks(AttackTables &t_tables)
+    {
+        uint64_t pawnPosition = (uint64_t) 1;
+        for (int sq = 0; sq < 64; sq ++ , pawnPosition <<= 1){
+            uint64_t nortDir = pawnPosition << 8;
+            uint64_t soutDir = pawnPosition >> 8;
+
+            t_tables.pawnAttacks[sq][white] = btw::cpyWrapEast(nortDir) | btw::cpyWrapWest(nortDir);
+            t_tables.pawnAttacks[sq][black] = btw::cpyWrapEast(soutDir) | btw::cpyWrapWest(soutDir);
+            t_tables.pawnPushes [sq][white] = nortDir;
+            t_tables.pawnPushes [sq][black] = soutDir;
+        }    
+    }
+
+    void initMagicMoves(AttackTables &t_tables)
+    {
+        for (int i = 0; i < 64; i++){
+            int squares[64];
+            int numSquares = 0;
+            uint64_t tmp = t_tables.bMask[i];
+
+            if (tmp) do {
+                squares[numSquares ++] = btw::bitScanForward(tmp);
+            } while (tmp &= (tmp - 1));
+
+            for(uint64_t occSeq = 0; occSeq < ((uint64_t) 1 << numSquares); occSeq++){
+                uint64_t tmpOcc = initMagicOcc(squares, numSquares, occSeq);
+                t_tables.bMagicDb[i][(tmpOcc * t_tables.bMagic[i]) >> t_tables.bShift[i]] = initMagicBMoves(i,tmpOcc);
+                // without applying the mask
+                // the for loop should ensure that all combination of active masked bits are computed and
+                // stored in the Magic database. The funcion `initMagicOcc` returns the right bit combination
+                // for a given sequence of on and off bits in the mask (represented by occSeq, wich stores the
+                // bit sequence, but each bit is not in the right place of the bitboard)
+            }
+        }
+
+        for (int i = 0; i < 64; i++){
+            int squares[64];
+            int numSquares = 0;
+            uint64_t tmp = t_tables.rMask[i];
+
+            if (tmp) do {
+                squares[numSquares ++] = btw::bitScanForward(tmp);
+            } while (tmp &= (tmp - 1));
+
+            for(uint64_t occSeq = 0;occSeq < ((uint64_t) 1 << numSquares); occSeq++){
+                uint64_t tmpOcc = initMagicOcc(squares, numSquares, occSeq);
+                t_tables.rMagicDb[i][(tmpOcc * t_tables.rMagic[i]) >> t_tables.rShift[i]] = initMagicRMoves(i,tmpOcc);
+            }
+        }
+    }
+
+    // software pdep, the machine running the generator does not need BMI2
+    uint64_t depositBits(uint64_t t_bits, uint64_t t_mask){
+        int squares[64];
+        int numSquares = 0;
+        if (t_mask) do {
+            squares[numSquares ++] = btw::bitScanForward(t_mask);
+        } while (t_mask &= (t_mask - 1));
+        return initMagicOcc(squares, numSquares, t_bits);
+    }
+
+    void initPextMoves(AttackTables &t_tables)
+    {
+        int rOffset = 0, bOffset = 0;
+        for (int i = 0; i < 64; i++){
+            // spreading the index bits over the mask, as pdep does, gives the occupancy that pext maps back to index
+            t_tables.rPextOffset[i] = rOffset;
+            for (uint64_t index = 0; index < ((uint64_t) 1 << btw::popCount(t_tables.rMask[i])); index ++)
+                t_tables.rPextDb[rOffset ++] = initMagicRMoves(i, depositBits(index, t_tables.rMask[i]));
+
+            t_tables.bPextOffset[i] = bOffset;
+            for (uint64_t index = 0; index < ((uint64_t) 1 << btw::popCount(t_tables.bMask[i])); index ++)
+                t_tables.bPextDb[bOffset ++] = initMagicBMoves(i, depositBits(index, t_tables.bMask[i]));
+        }
+    }
+
+    template <typename T>
+    void writeArray(std::ostream &os, const char *t_name, const T *t_values, size_t t_count){
+        os << "    ." << t_name << " = {";
+        char buffer[32];
+        for (size_t i = 0; i < t_count; i ++){
+            std::snprintf(buffer, sizeof(buffer), "0x%llx,", (unsigned long long) t_values[i]);
+            os << (i % 8 == 0 ? "\n        " : " ") << buffer;
+        }
+        os << "\n    },\n";
+    }
+}
+
+int main(int argc, char *argv[]){
+    if (argc != 2){
+        std::cerr << "usage: " << argv[0] << " <output file>" << std::endl;
+        return 1;
+    }
+
+    auto tables = std::make_unique<AttackTables>();
+    std::copy(std::begin(rShift), std::end(rShift), tables->rShift);
+    std::copy(std::begin(rMask), std::end(rMask), tables->rMask);
+    std::copy(std::begin(rMagic), std::end(rMagic), tables->rMagic);
+    std::copy(std::begin(bShift), std::end(bShift), tables->bShift);
+    std::copy(std::begin(bMask), std::end(bMask), tables->bMask);
+    std::copy(std::begin(bMagic), std::end(bMagic), tables->bMagic);
+
+    initRayAttacks(*tables);
+    initLines(*tables);
+    initKnightAttacks(*tables);
+    initKingAttacks(*tables);
+    initPawnAttacks(*tables);
+    initMagicMoves(*tables);
+    initPextMoves(*tables);
+
+    std::ofstream out(argv[1]);
+    out << "// Generated by tools/TableGenerator.cpp, do not edit\n\n#include \"AttackTables.h\"\n\n"
+        << "const AttackTables attackTables = {\n";
+    writeArray(out, "rayAttacks", &tables->rayAttacks[0][0], 64 * 8);
+    writeArray(out, "between", &tables->between[0][0], 64 * 64);
+    writeArray(out, "line", &tables->line[0][0], 64 * 64);
+    writeArray(out, "knightAttacks", tables->knightAttacks, 64);
+    writeArray(out, "kingAttacks", tables->kingAttacks, 64);
+    writeArray(out, "pawnAttacks", &tables->pawnAttacks[0][0], 64 * 2);
+    writeArray(out, "pawnPushes", &tables->pawnPushes[0][0], 64 * 2);
+    writeArray(out, "rShift", tables->rShift, 64);
+    writeArray(out, "rMask", tables->rMask, 64);
+    writeArray(out, "rMagic", tables->rMagic, 64);
+    writeArray(out, "bShift", tables->bShift, 64);
+    writeArray(out, "bMask", tables->bMask, 64);
+    writeArray(out, "bMagic", tables->bMagic, 64);
+    writeArray(out, "rMagicDb", &tables->rMagicDb[0][0], 64 << 12);
+    writeArray(out, "bMagicDb", &tables->bMagicDb[0][0], 64 << 9);
+    writeArray(out, "rPextOffset", tables->rPextOffset, 64);
+    writeArray(out, "bPextOffset", tables->bPextOffset, 64);
+    writeArray(out, "rPextDb", tables->rPextDb, 102400);
+    writeArray(out, "bPextDb", tables->bPextDb, 5248);
+    out << "};\n";
+
+    return out.good() ? 0 : 1;
+}